@@ -8,10 +8,12 @@
 #include "elib/elib.h"
 #include "elib/m_argv.h"
 #include "hal/hal_input.h"
+#include "hal/hal_platform.h"
 #include "hal/hal_timer.h"
 #endif
 #include "doomdef.h"
 #include "g_options.h"
+#include "w_cache.h"
  
 unsigned int BT_ATTACK = BT_B;
 unsigned int BT_USE    = BT_C;
@@ -32,6 +34,7 @@ int     warpdest  = 0;         // CALICO: allow -warp, -skill
 int     warpskill = sk_medium;
 boolean fastparm   = false;    // CALICO: allow -fast
 boolean nomonsters = false;    // CALICO: allow -nomonsters
+boolean dormantparm = false;   // CALICO: allow -dormant
 
 /*============================================================================ */
 
@@ -606,8 +609,41 @@ static void D_CheckGameArguments(void)
       }
    }
 
-   fastparm   = (boolean)(M_FindArgument("-fast"));       // -fast
-   nomonsters = (boolean)(M_FindArgument("-nomonsters")); // -nomonsters   
+   fastparm    = (boolean)(M_FindArgument("-fast"));       // -fast
+   nomonsters  = (boolean)(M_FindArgument("-nomonsters")); // -nomonsters   
+   dormantparm = (boolean)(M_FindArgument("-dormant"));    // -dormant
+}
+#endif
+
+#ifndef YAUL_DOOM
+//
+// CALICO: report decoder throughput over every compressed lump, then quit
+//
+static void D_BenchDecode(void)
+{
+   int    count, bytes;
+   double bytembs, crymbs;
+
+   count = R_BenchDecode(&bytes, &bytembs, &crymbs);
+
+   hal_platform.exitWithMsg(
+      "%d compressed lumps, %d bytes decoded per pass\n"
+      "W_Decode: %.1f MB/s\n"
+      "R_decode (with CRY expansion): %.1f MB/s",
+      count, bytes, bytembs, crymbs);
+}
+
+//
+// CALICO: write the fast-load cache for the current IWAD, then quit
+//
+static void D_BuildCache(void)
+{
+   char msg[256];
+
+   if(!W_BuildCache(msg, sizeof(msg)))
+      hal_platform.fatalError("%s", msg);
+
+   hal_platform.exitWithMsg("%s", msg);
 }
 #endif
 
@@ -629,6 +665,12 @@ void D_DoomMain(void)
    Z_Init(); 
    D_printf("W_Init\n");
    W_Init();
+
+#ifndef YAUL_DOOM
+   // CALICO: -benchdecode times the LZSS decoders and exits
+   if(M_FindArgument("-benchdecode"))
+      D_BenchDecode();
+#endif
    D_printf("I_Init\n");
    I_Init(); 
    D_printf("R_Init\n");
@@ -641,6 +683,12 @@ void D_DoomMain(void)
    ST_Init();
    O_Init();
 
+#ifndef YAUL_DOOM
+   // CALICO: -buildcache preprocesses the IWAD and exits
+   if(M_FindArgument("-buildcache"))
+      D_BuildCache();
+#endif
+
 #ifndef YAUL_DOOM
    // CALICO: check for -warp
    D_CheckGameArguments();
@@ -194,6 +194,12 @@ typedef struct mobj_s
    // CALICO: reference counting
    struct mobj_s *extramobj;    // for latecall functions that need an mobj_t *
    int            references;   // number of other mobjs with references to this mobj
+
+   // CALICO: sectors this thing touches, for P_ChangeSector
+   struct msecnode_s *touching_sectorlist;
+
+   // CALICO: gametic on which the thing went dormant
+   int dormanttic;
 } mobj_t;
 
 // each sector has a degenmobj_t in it's center for sound origin purposes
@@ -245,6 +251,7 @@ typedef struct
 #define MF_NOTDMATCH    0x2000000 // don't spawn in death match (key cards)
 
 #define MF_SEETARGET    0x4000000 // is target visible?
+#define MF_DORMANT      0x8000000 // CALICO: idle monster parked by dormant scheduling
 
 //=============================================================================
 
@@ -516,13 +523,38 @@ typedef struct memblock_s
    struct memblock_s *prev;
 } memblock_t;
 
+// CALICO: zone allocators
+enum
+{
+   ZA_ROVER, // original first-fit rover over the block list
+   ZA_TLSF   // two-level segregated fit; free blocks are kept in size classes
+};
+
+#define ZFLCOUNT 25 // first-level size classes, by power of two
+#define ZSLCOUNT 8  // second-level divisions of each
+
 typedef struct
 {
-   int         size;      // total bytes malloced, including header
-   memblock_t *rover;
-   memblock_t  blocklist; // start / end cap for linked list
+   int          size;      // total bytes malloced, including header
+   memblock_t  *rover;
+   int          allocator; // CALICO: ZA_ROVER or ZA_TLSF
+   unsigned int flbitmap;  // CALICO: first levels that have free blocks
+   unsigned int slbitmap[ZFLCOUNT];            // CALICO: second levels that do
+   memblock_t  *freelists[ZFLCOUNT][ZSLCOUNT]; // CALICO: free blocks by size
+   memblock_t   blocklist; // start / end cap for linked list
 } memzone_t;
 
+// CALICO: results of Z_BenchZone
+typedef struct zonebench_s
+{
+   int    allocs;      // allocations attempted
+   int    failures;    // allocations that found no room
+   double avgus;       // mean time per allocation, in microseconds
+   double maxus;       // worst time for one allocation
+   int    freebytes;   // free at the end
+   int    largestfree; // largest run of free memory at the end
+} zonebench_t;
+
 
 extern int framecount;
 
@@ -530,8 +562,9 @@ extern memzone_t *mainzone;
 extern memzone_t *refzone;
 
 void       Z_Init(void);
-memzone_t *Z_InitZone(byte *base, int size);
+memzone_t *Z_InitZone(byte *base, int size, int allocator);
 void      *Z_Malloc2(memzone_t *mainzone, int size, int tag, void *ptr);
+void      *Z_TryMalloc(memzone_t *mainzone, int size, int tag, void *ptr); // CALICO
 void       Z_Free2(memzone_t *mainzone,void *ptr);
 
 #define Z_Malloc(x, y, z) Z_Malloc2(mainzone, x, y, z)
@@ -541,6 +574,8 @@ void Z_FreeTags(memzone_t *mainzone);
 void Z_CheckHeap(memzone_t *mainzone);
 void Z_ChangeTag(void *ptr, int tag);
 int  Z_FreeMemory(memzone_t *mainzone);
+int  Z_LargestFree(memzone_t *mainzone);                  // CALICO
+void Z_BenchZone(int allocator, int seed, zonebench_t *bench); // CALICO
 
 //------- //
 //WADFILE //
@@ -562,13 +597,14 @@ typedef struct
 #pragma pack(pop)
 #endif
 
-#define MAXLUMPS 2048
+#define MAXWADFILES 16 // CALICO: most PWADs that can be given with -file
 
 extern byte *wadfileptr;
 
 extern lumpinfo_t *lumpinfo; // points directly to rom image
 extern int         numlumps;
-extern void       *lumpcache[MAXLUMPS];
+extern void      **lumpcache; // CALICO: sized to numlumps by W_Init
+extern byte      **lumpbase;  // CALICO: start of the file holding each lump
 
 void  W_Init(void);
 int   W_CheckNumForName(const char *name);
@@ -578,8 +614,22 @@ void  W_ReadLump(int lump, void *dest);
 void *W_CacheLumpNum(int lump, int tag);
 void *W_CacheLumpName(const char *name, int tag);
 int   W_strncasecmp(const char *s1, const char *s2, int len);
+int   W_Decode(const byte *input, byte *output); // CALICO
+
+// CALICO: read-only view of a lump's data, for converting it straight from
+// the WAD image without first copying it to a buffer
+typedef struct lumpview_s
+{
+   const void *data;
+   int         size;
+   void       *scratch; // zone block the lump was decoded into, if any
+   void       *owned;   // malloc'd block taken from the prefetcher, if any
+} lumpview_t;
+
+const void *W_OpenLumpView(int lump, lumpview_t *view);
+void        W_CloseLumpView(lumpview_t *view);
 
-#define W_POINTLUMPNUM(x) (void*)(wadfileptr + BIGLONG(lumpinfo[x].filepos))
+#define W_POINTLUMPNUM(x) (void*)(lumpbase[x] + BIGLONG(lumpinfo[x].filepos))
 
 //---------- //
 //BASE LEVEL //
@@ -606,6 +656,7 @@ extern gametype_t starttype;
 
 void  I_Init(void);
 byte *I_WadBase(void);
+int   I_PWadBases(byte **files, size_t *sizes, int maxfiles); // CALICO
 byte *I_ZoneBase(int *size);
 
 // return a pointer to a 64k or so temp work buffer for level setup uses 
@@ -620,6 +671,8 @@ unsigned int I_NetTransfer(unsigned int buttons);
 boolean I_RefreshCompleted(void);
 boolean I_RefreshLatched(void);
 int     I_GetTime(void);
+int     I_GetTimeMS(void); // CALICO
+unsigned int I_GetTimeUS(void); // CALICO
 
 void I_Update(void);
 void I_Error(const char *error, ...);
@@ -696,10 +749,12 @@ struct seg_s;
 void R_RenderPlayerView(void);
 void R_Init(void);
 int  R_FlatNumForName(const char *name);
+int  R_CheckFlatNumForName(const char *name);
 int  R_TextureNumForName(const char *name);
 int  R_CheckTextureNumForName(const char *name);
 angle_t R_PointToAngle2(fixed_t x1, fixed_t y1, fixed_t x2, fixed_t y2);
 struct subsector_s *R_PointInSubsector(fixed_t x, fixed_t y);
+int  R_BenchDecode(int *bytes, double *bytembs, double *crymbs); // CALICO
 
 //---- //
 //MISC //
@@ -799,6 +854,7 @@ extern int vblsinframe; // range from 4 to 8
 
 extern boolean fastparm;   // CALICO: -fast support
 extern boolean nomonsters; // CALICO: -nomonsters support
+extern boolean dormantparm; // CALICO: -dormant support
 
 void I_DrawSbar(void);
 void S_StartSong(int music_id, int looping);
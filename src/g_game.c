@@ -8,6 +8,7 @@
 #include "doomdef.h" 
 #include "g_options.h"
 #include "p_local.h" 
+#include "w_prefetch.h"
  
 void G_PlayerReborn(int player); 
  
@@ -413,6 +414,9 @@ void G_RunGame(void)
          }
       }
 
+      // CALICO: start loading the next map while the intermission runs
+      W_StartPrefetch(nextmap);
+
       // run a stats intermission
       MiniLoop(IN_Start, IN_Stop, IN_Ticker, IN_Drawer);
 
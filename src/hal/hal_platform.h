@@ -40,6 +40,8 @@ typedef struct hal_platform_s
    void        (*setIcon)(void);
    FILE       *(*fileOpen)(const char *path, const char *mode);
    hal_bool    (*fileExists)(const char *path);
+   void       *(*mapFile)(FILE *f, size_t *size);
+   void        (*unmapFile)(void *data, size_t size);
 } hal_platform_t;
 
 #ifdef __cplusplus
@@ -0,0 +1,58 @@
+/*
+  CALICO
+  
+  HAL Thread Interface
+  
+  The MIT License (MIT)
+  
+  Copyright (c) 2016 James Haley
+  
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+  
+  The above copyright notice and this permission notice shall be included in all
+  copies or substantial portions of the Software.
+  
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+*/
+
+#ifndef HAL_THREAD_H__
+#define HAL_THREAD_H__
+
+typedef int (*hal_threadfunc_t)(void *data);
+
+//
+// Worker threads. The game itself is single-threaded; threads are only used
+// for self-contained work whose results are handed over once it has been
+// waited on.
+//
+typedef struct hal_thread_s
+{
+   void *(*createThread)(hal_threadfunc_t fn, const char *name, void *data);
+   int   (*waitThread)(void *thread);
+} hal_thread_t;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+extern hal_thread_t hal_thread;
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
+
+// EOF
+
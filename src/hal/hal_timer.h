@@ -36,6 +36,7 @@ typedef struct hal_timer_s
    void         (*delay)(unsigned int ms);
    unsigned int (*getTime)(void);
    unsigned int (*getTimeMS)(void);
+   unsigned int (*getTimeUS)(void);
 } hal_timer_t;
 
 #ifdef __cplusplus
@@ -397,6 +397,18 @@ byte *I_WadBase(void)
    return wadbase;
 }
 
+//
+// CALICO: load the PWADs given with -file, returning how many there are
+//
+int I_PWadBases(byte **files, size_t *sizes, int maxfiles)
+{
+#ifndef YAUL_DOOM
+   return W_LoadPWADs(files, sizes, maxfiles);
+#else
+   return 0;
+#endif
+}
+
 /* 
 ==================== 
 = 
@@ -481,6 +493,32 @@ int I_GetTime(void)
 #endif
 }
 
+//
+// CALICO: Get time in milliseconds from HAL, for profiling
+//
+int I_GetTimeMS(void)
+{
+#ifdef YAUL_DOOM
+   // YAUL_TODO: implement time
+   return 0;
+#else
+   return (int)(hal_timer.getTimeMS());
+#endif
+}
+
+//
+// CALICO: Get time in microseconds from HAL, for timing short operations.
+// Wraps around, so only differences are meaningful.
+//
+unsigned int I_GetTimeUS(void)
+{
+#ifdef YAUL_DOOM
+   return 0;
+#else
+   return hal_timer.getTimeUS();
+#endif
+}
+
 //
 // Perform a signed 16.16 by 16.16 mutliply
 //
@@ -557,11 +557,19 @@ void P_RemoveMobjDeferred(mobj_t *mobj)
 //
 void P_RunMobjBase2()
 {
+   dormantskipped = 0;
+
    for(currentmobj = mobjhead.next; currentmobj != &mobjhead; currentmobj = currentmobj->next)
    {
       if(currentmobj->latecall == P_RemoveMobjDeferred)
          continue; // CALICO: not if about to be removed.
 
+      if(currentmobj->flags & MF_DORMANT)
+      {
+         dormantskipped++; // CALICO: parked by dormant scheduling
+         continue;
+      }
+
       if (!currentmobj->player) {
           // clear any latecall from the previous frame
           currentmobj->latecall = NULL;
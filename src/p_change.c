@@ -80,6 +80,8 @@ boolean PIT_ChangeSector(mobj_t *thing)
 {
    mobj_t *mo;
 
+   P_WakeMobj(thing); // CALICO: height may change under a dormant thing
+
    if(P_ThingHeightClip(thing))
       return true; /* keep checking */
 
@@ -120,6 +122,9 @@ boolean PIT_ChangeSector(mobj_t *thing)
 =
 = P_ChangeSector
 =
+= CALICO: only the things on the sector's touching list are re-clipped.
+= Demos still visit the whole blockbox, in blockmap order, so that they play
+= back exactly as recorded.
 ===============
 */
 
@@ -127,6 +132,7 @@ boolean P_ChangeSector(doom_sector_t *sector, boolean crunch)
 {
    int x, y;
    int i;
+   msecnode_t *node;
 
    /* force next sound to reflood */
    for(i = 0; i < MAXPLAYERS; i++)
@@ -135,13 +141,38 @@ boolean P_ChangeSector(doom_sector_t *sector, boolean crunch)
    nofit = false;
    crushchange = crunch;
 
-   /* recheck heights for all things near the moving sector */
-   for(x = sector->blockbox[BOXLEFT]; x <= sector->blockbox[BOXRIGHT]; x++)
+   if(demoplayback || demorecording)
+   {
+      /* recheck heights for all things near the moving sector */
+      for(x = sector->blockbox[BOXLEFT]; x <= sector->blockbox[BOXRIGHT]; x++)
+      {
+         for(y = sector->blockbox[BOXBOTTOM]; y <= sector->blockbox[BOXTOP]; y++)
+            P_BlockThingsIterator(x, y, PIT_ChangeSector);
+      }
+
+      return nofit;
+   }
+
+   /* recheck heights for all things touching the moving sector */
+   for(node = sector->touching_thinglist; node; node = node->m_snext)
+      node->visited = false;
+
+   /* things can be removed or spawned while they are being crunched, which */
+   /* changes the list, so restart from the head after each one */
+   do
    {
-      for(y = sector->blockbox[BOXBOTTOM]; y <= sector->blockbox[BOXTOP]; y++)
-         P_BlockThingsIterator(x, y, PIT_ChangeSector);
+      for(node = sector->touching_thinglist; node; node = node->m_snext)
+      {
+         if(!node->visited)
+         {
+            node->visited = true;
+            PIT_ChangeSector(node->m_thing);
+            break;
+         }
+      }
    }
-	
+   while(node);
+
    return nofit;
 }
 
@@ -344,6 +344,207 @@ newtarget:
 /*
 ===============================================================================
 
+DORMANT MONSTERS
+
+CALICO: with -dormant, a monster idling in A_Look that no player could
+possibly see is parked and its thinker is skipped until something happens
+that could make it react: a noise reaching its sector, a player entering
+a sector the reject table says is visible from it, or taking damage.
+Idle looking uses no random numbers, so the only state a parked monster
+misses is its tic counter, which is caught back up when it wakes. Parked
+monsters stay on the mobj list, since telefragging, boss deaths and the
+automap all still need to find them.
+
+===============================================================================
+*/
+
+int numdormant;     // monsters currently parked
+int dormantskipped; // mobj thinkers skipped this tic
+
+static doom_sector_t *dormantplayersec[MAXPLAYERS];
+
+/*
+==================
+=
+= P_DormantEnabled
+=
+= Never during demos, which must play back exactly as recorded
+=
+==================
+*/
+
+static boolean P_DormantEnabled(void)
+{
+   return dormantparm && !demoplayback && !demorecording;
+}
+
+/*
+==================
+=
+= P_SectorVisible
+=
+= True if the reject table allows sight from sector s1 into s2
+=
+==================
+*/
+
+static boolean P_SectorVisible(int s1, int s2)
+{
+   int pnum = s1*numsectors + s2;
+
+   return !(rejectmatrix[pnum>>3] & (1 << (pnum&7)));
+}
+
+/*
+==================
+=
+= P_InitDormant
+=
+==================
+*/
+
+void P_InitDormant(void)
+{
+   int i;
+
+   numdormant     = 0;
+   dormantskipped = 0;
+
+   for(i = 0; i < MAXPLAYERS; i++)
+      dormantplayersec[i] = NULL;
+}
+
+/*
+==================
+=
+= P_ParkMobj
+=
+= Called from A_Look when the actor did not see its target
+=
+==================
+*/
+
+static void P_ParkMobj(mobj_t *actor)
+{
+   int i, secnum;
+
+   if(!P_DormantEnabled())
+      return;
+
+   // must be standing still on the floor
+   if(actor->momx || actor->momy || actor->momz || actor->z != actor->floorz)
+      return;
+   if(actor->flags & (MF_SKULLFLY|MF_JUSTHIT|MF_DORMANT))
+      return;
+
+   // no player may be in a sector that can see this one
+   secnum = (int)(actor->subsector->sector - sectors);
+   for(i = 0; i < MAXPLAYERS; i++)
+   {
+      if(!playeringame[i] || !players[i].mo)
+         continue;
+      if(P_SectorVisible(secnum, (int)(players[i].mo->subsector->sector - sectors)))
+         return;
+   }
+
+   actor->flags     |= MF_DORMANT;
+   actor->dormanttic = gametic;
+   actor->latecall   = NULL; // don't look again from P_RunMobjExtra
+   numdormant++;
+}
+
+/*
+==================
+=
+= P_WakeMobj
+=
+==================
+*/
+
+void P_WakeMobj(mobj_t *mo)
+{
+   int      elapsed;
+   state_t *st;
+
+   if(!(mo->flags & MF_DORMANT))
+      return;
+
+   mo->flags &= ~MF_DORMANT;
+   numdormant--;
+
+   // run the state cycle forward over the tics that were skipped, so the
+   // thing reaches its next sight check on the tic it would have anyway
+   elapsed = gametic - mo->dormanttic - 1;
+   while(elapsed > 0 && elapsed >= mo->tics)
+   {
+      elapsed -= mo->tics;
+
+      st = &states[mo->state->nextstate];
+      mo->state  = st;
+      mo->tics   = st->tics;
+      mo->sprite = st->sprite;
+      mo->frame  = st->frame;
+   }
+   if(elapsed > 0)
+      mo->tics -= elapsed;
+}
+
+/*
+==================
+=
+= P_WakeSectorMobjs
+=
+==================
+*/
+
+void P_WakeSectorMobjs(doom_sector_t *sec)
+{
+   mobj_t *mo;
+
+   for(mo = sec->thinglist; mo; mo = mo->snext)
+      P_WakeMobj(mo);
+}
+
+/*
+==================
+=
+= P_CheckDormantWake
+=
+= Wake everything that can see a sector a player has just entered
+=
+==================
+*/
+
+void P_CheckDormantWake(void)
+{
+   int i, s, secnum;
+   doom_sector_t *sec;
+
+   for(i = 0; i < MAXPLAYERS; i++)
+   {
+      if(!playeringame[i] || !players[i].mo)
+         continue;
+
+      sec = players[i].mo->subsector->sector;
+      if(sec == dormantplayersec[i])
+         continue;
+      dormantplayersec[i] = sec;
+
+      if(!numdormant)
+         continue;
+
+      secnum = (int)(sec - sectors);
+      for(s = 0; s < numsectors; s++)
+      {
+         if(P_SectorVisible(s, secnum))
+            P_WakeSectorMobjs(&sectors[s]);
+      }
+   }
+}
+
+/*
+===============================================================================
+
 ACTION ROUTINES
 
 ===============================================================================
@@ -363,7 +564,10 @@ void A_Look (mobj_t *actor)
 {
    // if current target is visible, start attacking
    if(!P_LookForPlayers(actor, false))
+   {
+      P_ParkMobj(actor); // CALICO
       return;
+   }
 
    // go into chase state
    if(actor->info->seesound)
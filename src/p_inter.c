@@ -658,6 +658,8 @@ void P_DamageMobj(mobj_t *target, mobj_t *inflictor, mobj_t *source, int damage)
    if(target->health <= 0)
       return;
 
+   P_WakeMobj(target); // CALICO
+
    if(target->flags & MF_SKULLFLY)
    {
       target->momx = target->momy = target->momz = 0;
@@ -137,6 +137,15 @@ P_ENEMY
 void A_MissileExplode(mobj_t *mo);
 void A_SkullBash(mobj_t *mo);
 
+// CALICO: dormant monster scheduling
+extern int numdormant;     /* monsters currently parked */
+extern int dormantskipped; /* mobj thinkers skipped this tic */
+
+void P_InitDormant(void);
+void P_WakeMobj(mobj_t *mo);
+void P_WakeSectorMobjs(doom_sector_t *sec);
+void P_CheckDormantWake(void);
+
 /*
 ===============================================================================
 
@@ -171,6 +180,28 @@ void P_UnsetThingPosition(mobj_t *thing);
 void P_SetThingPosition(mobj_t *thing);
 void P_PlayerLand(mobj_t *mo);
 
+boolean P_BoxCrossLine(line_t *ld, fixed_t *box);
+
+//
+// CALICO: sector touching lists
+//
+// Each blockmap-linked thing keeps a list of the sectors its bounding box
+// touches, and each sector keeps a list of the things touching it. Every
+// node sits on both lists at once.
+//
+typedef struct msecnode_s
+{
+   doom_sector_t     *m_sector; // a sector touched by this thing
+   mobj_t            *m_thing;  // the thing
+   struct msecnode_s *m_tprev;  // prev node for this thing
+   struct msecnode_s *m_tnext;  // next node for this thing
+   struct msecnode_s *m_sprev;  // prev node for this sector
+   struct msecnode_s *m_snext;  // next node for this sector
+   boolean            visited;  // used by P_ChangeSector
+} msecnode_t;
+
+void P_InitSecNodes(void);
+
 /*
 ===============================================================================
 
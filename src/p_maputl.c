@@ -172,6 +172,223 @@ void P_LineOpening (line_t *linedef)
 /*
 ===============================================================================
 
+SECTOR TOUCHING LISTS
+
+CALICO: P_ChangeSector used to re-clip every thing in the blockbox of a
+moving sector. Instead, each blockmap-linked thing is linked into the
+touching list of every sector that its bounding box contacts, using the same
+test that P_CheckPosition uses to pick up floor and ceiling heights, so the
+moving sector only needs to visit the things that can be affected by it.
+
+===============================================================================
+*/
+
+static msecnode_t *headsecnode; // free list of unused nodes
+
+/*
+==================
+=
+= P_InitSecNodes
+=
+= Nodes are PU_LEVEL and are thrown away at each level load
+==================
+*/
+
+void P_InitSecNodes(void)
+{
+   headsecnode = NULL;
+}
+
+/*
+==================
+=
+= P_BoxCrossLine
+=
+= True if the line crosses through the bounding box
+==================
+*/
+
+boolean P_BoxCrossLine(line_t *ld, fixed_t *box)
+{
+   fixed_t x1, x2, y1, y2;
+   fixed_t lx, ly, ldx, ldy;
+   fixed_t dx1, dx2, dy1, dy2;
+   boolean side1, side2;
+
+   if(box[BOXRIGHT ] <= ld->bbox[BOXLEFT  ] ||
+      box[BOXLEFT  ] >= ld->bbox[BOXRIGHT ] ||
+      box[BOXTOP   ] <= ld->bbox[BOXBOTTOM] ||
+      box[BOXBOTTOM] >= ld->bbox[BOXTOP   ])
+   {
+      return false; // bounding boxes don't intersect
+   }
+
+   y1 = box[BOXTOP   ];
+   y2 = box[BOXBOTTOM];
+
+   if(ld->slopetype == ST_POSITIVE)
+   {
+      x1 = box[BOXLEFT ];
+      x2 = box[BOXRIGHT];
+   }
+   else
+   {
+      x1 = box[BOXRIGHT];
+      x2 = box[BOXLEFT ];
+   }
+
+   lx  = ld->v1->x;
+   ly  = ld->v1->y;
+   ldx = (ld->v2->x - lx) >> FRACBITS;
+   ldy = (ld->v2->y - ly) >> FRACBITS;
+
+   dx1 = (x1 - lx) >> FRACBITS;
+   dy1 = (y1 - ly) >> FRACBITS;
+   dx2 = (x2 - lx) >> FRACBITS;
+   dy2 = (y2 - ly) >> FRACBITS;
+
+   side1 = (ldy * dx1 < dy1 * ldx);
+   side2 = (ldy * dx2 < dy2 * ldx);
+
+   return (side1 != side2);
+}
+
+/*
+==================
+=
+= P_AddSecNode
+=
+= Links the thing into the sector, unless it is already there
+==================
+*/
+
+static void P_AddSecNode(doom_sector_t *sec, mobj_t *thing)
+{
+   msecnode_t *node;
+
+   for(node = thing->touching_sectorlist; node; node = node->m_tnext)
+   {
+      if(node->m_sector == sec)
+         return; // already touching
+   }
+
+   if((node = headsecnode) != NULL)
+      headsecnode = node->m_snext;
+   else
+      node = Z_Malloc(sizeof(*node), PU_LEVEL, 0);
+
+   node->m_sector = sec;
+   node->m_thing  = thing;
+   node->visited  = false;
+
+   // link into the thing's list
+   node->m_tprev = NULL;
+   node->m_tnext = thing->touching_sectorlist;
+   if(node->m_tnext)
+      node->m_tnext->m_tprev = node;
+   thing->touching_sectorlist = node;
+
+   // link into the sector's list
+   node->m_sprev = NULL;
+   node->m_snext = sec->touching_thinglist;
+   if(node->m_snext)
+      node->m_snext->m_sprev = node;
+   sec->touching_thinglist = node;
+}
+
+/*
+==================
+=
+= P_DelSecNodeList
+=
+= Unlinks the thing from all of the sectors it touches
+==================
+*/
+
+static void P_DelSecNodeList(mobj_t *thing)
+{
+   msecnode_t *node, *next;
+
+   for(node = thing->touching_sectorlist; node; node = next)
+   {
+      next = node->m_tnext;
+
+      if(node->m_sprev)
+         node->m_sprev->m_snext = node->m_snext;
+      else
+         node->m_sector->touching_thinglist = node->m_snext;
+      if(node->m_snext)
+         node->m_snext->m_sprev = node->m_sprev;
+
+      // return to the free list
+      node->m_snext = headsecnode;
+      headsecnode = node;
+   }
+
+   thing->touching_sectorlist = NULL;
+}
+
+/*
+==================
+=
+= P_CreateSecNodeList
+=
+= Finds every sector that the thing's bounding box contacts. This does not
+= use P_BlockLinesIterator, because bumping validcount here could disturb a
+= line iteration that is in progress when a thing is spawned or moved.
+==================
+*/
+
+static void P_CreateSecNodeList(mobj_t *thing)
+{
+   fixed_t  box[4];
+   int      xl, xh, yl, yh, bx, by;
+   short   *list;
+   line_t  *ld;
+
+   // the sector that contains the thing's origin
+   P_AddSecNode(thing->subsector->sector, thing);
+
+   box[BOXTOP   ] = thing->y + thing->radius;
+   box[BOXBOTTOM] = thing->y - thing->radius;
+   box[BOXRIGHT ] = thing->x + thing->radius;
+   box[BOXLEFT  ] = thing->x - thing->radius;
+
+   xl = (box[BOXLEFT  ] - bmaporgx) >> MAPBLOCKSHIFT;
+   xh = (box[BOXRIGHT ] - bmaporgx) >> MAPBLOCKSHIFT;
+   yl = (box[BOXBOTTOM] - bmaporgy) >> MAPBLOCKSHIFT;
+   yh = (box[BOXTOP   ] - bmaporgy) >> MAPBLOCKSHIFT;
+
+   if(xl < 0)
+      xl = 0;
+   if(yl < 0)
+      yl = 0;
+   if(xh >= bmapwidth)
+      xh = bmapwidth - 1;
+   if(yh >= bmapheight)
+      yh = bmapheight - 1;
+
+   // the sectors on both sides of every line the box crosses
+   for(bx = xl; bx <= xh; bx++)
+   {
+      for(by = yl; by <= yh; by++)
+      {
+         for(list = blockmaplump + blockmap[by*bmapwidth+bx]; *list != -1; list++)
+         {
+            ld = &lines[*list];
+            if(!P_BoxCrossLine(ld, box))
+               continue;
+            P_AddSecNode(ld->frontsector, thing);
+            if(ld->backsector)
+               P_AddSecNode(ld->backsector, thing);
+         }
+      }
+   }
+}
+
+/*
+===============================================================================
+
 THING POSITION SETTING
 
 ===============================================================================
@@ -191,6 +408,10 @@ void P_UnsetThingPosition(mobj_t *thing)
 {
    int blockx, blocky;
 
+   // CALICO: drop out of the touching lists of all sectors
+   if(thing->touching_sectorlist)
+      P_DelSecNodeList(thing);
+
    if(!(thing->flags & MF_NOSECTOR))
    {	
       /* inert things don't need to be in blockmap */
@@ -233,7 +454,7 @@ void P_UnsetThingPosition(mobj_t *thing)
 
 void P_SetThingPosition(mobj_t *thing)
 {
-   subdoom_sector_t  *ss;
+   subsector_t  *ss;
    doom_sector_t     *sec;
    int           blockx, blocky;
    mobj_t      **link;
@@ -271,6 +492,9 @@ void P_SetThingPosition(mobj_t *thing)
          if (*link)
             (*link)->bprev = thing;
          *link = thing;
+
+         // CALICO: link into the touching lists of all contacted sectors
+         P_CreateSecNodeList(thing);
       }
       else
       {	
@@ -38,6 +38,9 @@ void P_RemoveMobj(mobj_t *mobj)
       iquehead++;
    }
 
+   // CALICO: stop counting it as dormant
+   P_WakeMobj(mobj);
+
    // unlink from sector and block lists
    P_UnsetThingPosition(mobj);
 
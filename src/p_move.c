@@ -120,47 +120,7 @@ boolean PIT_CheckThing(mobj_t *thing)
 //
 static boolean PM_BoxCrossLine(line_t *ld)
 {
-   fixed_t x1, x2, y1, y2;
-   fixed_t lx, ly, ldx, ldy;
-   fixed_t dx1, dx2, dy1, dy2;
-   boolean side1, side2;
-
-   if(tmbbox[BOXRIGHT ] <= ld->bbox[BOXLEFT  ] ||
-      tmbbox[BOXLEFT  ] >= ld->bbox[BOXRIGHT ] ||
-      tmbbox[BOXTOP   ] <= ld->bbox[BOXBOTTOM] ||
-      tmbbox[BOXBOTTOM] >= ld->bbox[BOXTOP   ])
-   {
-      return false; // bounding boxes don't intersect
-   }
-
-   y1 = tmbbox[BOXTOP   ];
-   y2 = tmbbox[BOXBOTTOM];
-
-   if(ld->slopetype == ST_POSITIVE)
-   {
-      x1 = tmbbox[BOXLEFT ];
-      x2 = tmbbox[BOXRIGHT];
-   }
-   else
-   {
-      x1 = tmbbox[BOXRIGHT];
-      x2 = tmbbox[BOXLEFT ];
-   }
-
-   lx  = ld->v1->x;
-   ly  = ld->v1->y;
-   ldx = (ld->v2->x - lx) >> FRACBITS;
-   ldy = (ld->v2->y - ly) >> FRACBITS;
-
-   dx1 = (x1 - lx) >> FRACBITS;
-   dy1 = (y1 - ly) >> FRACBITS;
-   dx2 = (x2 - lx) >> FRACBITS;
-   dy2 = (y2 - ly) >> FRACBITS;
-
-   side1 = (ldy * dx1 < dy1 * ldx);
-   side2 = (ldy * dx2 < dy2 * ldx);
-
-   return (side1 != side2);
+   return P_BoxCrossLine(ld, tmbbox); // CALICO: shared with P_CreateSecNodeList
 }
 
 //
@@ -42,6 +42,9 @@ void P_RecursiveSound(doom_sector_t *sec, int soundblocks)
    sec->validcount = validcount;
    sec->soundtraversed = soundblocks+1;
    sec->soundtarget = soundtarget;
+
+   if(numdormant)
+      P_WakeSectorMobjs(sec); // CALICO
 	
    for(i = 0; i < sec->linecount; i++)
    {
@@ -2,6 +2,8 @@
 
 #include "doomdef.h"
 #include "p_local.h"
+#include "w_cache.h"
+#include "w_prefetch.h"
 
 void P_SpawnMapThing(mapthing_t *mthing);
 
@@ -38,23 +40,23 @@ mapthing_t   playerstarts[MAXPLAYERS];
 
 void P_LoadVertexes(int lump)
 {
-   byte        *data;
-   int          i;
-   mapvertex_t *ml;
-   vertex_t    *li;
+   lumpview_t         view;
+   int                i;
+   const mapvertex_t *ml;
+   vertex_t          *li;
 
    numvertexes = W_LumpLength(lump) / sizeof(mapvertex_t);
    vertexes    = Z_Malloc(numvertexes * sizeof(vertex_t), PU_LEVEL, 0);
-   data = I_TempBuffer();
-   W_ReadLump(lump, data);
-   
-   ml = (mapvertex_t *)data;
+
+   // CALICO: convert straight from a view of the lump
+   ml = W_OpenLumpView(lump, &view);
    li = vertexes;
    for(i = 0; i < numvertexes; i++, li++, ml++)
    {
       li->x = LITTLESHORT(ml->x) << FRACBITS;
       li->y = LITTLESHORT(ml->y) << FRACBITS;
    }
+   W_CloseLumpView(&view);
 }
 
 /*
@@ -67,20 +69,18 @@ void P_LoadVertexes(int lump)
 
 void P_LoadSegs(int lump)
 {
-   byte     *data;
-   int       i;
-   mapseg_t *ml;
-   seg_t    *li;
-   line_t   *ldef;
-   int       linedef, side;
+   lumpview_t      view;
+   int             i;
+   const mapseg_t *ml;
+   seg_t          *li;
+   line_t         *ldef;
+   int             linedef, side;
 
    numsegs = W_LumpLength(lump) / sizeof(mapseg_t);
    segs    = Z_Malloc(numsegs * sizeof(seg_t), PU_LEVEL, 0);
    D_memset(segs, 0, numsegs * sizeof(seg_t));
-   data = I_TempBuffer();
-   W_ReadLump(lump, data);
 
-   ml = (mapseg_t *)data;
+   ml = W_OpenLumpView(lump, &view); // CALICO
    li = segs;
    for(i = 0; i < numsegs; i++, li++, ml++)
    {
@@ -104,6 +104,7 @@ void P_LoadSegs(int lump)
       if(ldef->v1 == li->v1)
          ldef->fineangle = li->angle >> ANGLETOFINESHIFT;
    }
+   W_CloseLumpView(&view);
 }
 
 
@@ -117,17 +118,15 @@ void P_LoadSegs(int lump)
 
 void P_LoadSubsectors(int lump)
 {
-   byte *data;
-   int   i;
-   mapsubsector_t *ms;
-   doom_sector_t    *ss;
+   lumpview_t view;
+   int        i;
+   const mapsubsector_t *ms;
+   subsector_t          *ss;
 
    numsubsectors = W_LumpLength(lump) / sizeof(mapsubsector_t);
    subsectors    = Z_Malloc(numsubsectors * sizeof(subsector_t), PU_LEVEL, 0);
-   data = I_TempBuffer();
-   W_ReadLump(lump, data);
 
-   ms = (mapsubsector_t *)data;
+   ms = W_OpenLumpView(lump, &view); // CALICO
    D_memset (subsectors,0, numsubsectors * sizeof(subsector_t));
    ss = subsectors;
    for(i = 0; i < numsubsectors; i++, ss++, ms++)
@@ -135,6 +134,7 @@ void P_LoadSubsectors(int lump)
       ss->numlines  = LITTLESHORT(ms->numsegs);
       ss->firstline = LITTLESHORT(ms->firstseg);
    }
+   W_CloseLumpView(&view);
 }
 
 /*
@@ -147,18 +147,16 @@ void P_LoadSubsectors(int lump)
 
 void P_LoadSectors(int lump)
 {
-   byte *data;
-   int   i;
-   mapsector_t *ms;
-   doom_sector_t    *ss;
+   lumpview_t view;
+   int        i;
+   const mapsector_t *ms;
+   doom_sector_t     *ss;
 
    numsectors = W_LumpLength(lump) / sizeof(mapsector_t);
    sectors    = Z_Malloc(numsectors * sizeof(doom_sector_t), PU_LEVEL, 0);
    D_memset(sectors, 0, numsectors * sizeof(doom_sector_t));
-   data = I_TempBuffer();
-   W_ReadLump(lump, data);
 
-   ms = (mapsector_t *)data;
+   ms = W_OpenLumpView(lump, &view); // CALICO
    ss = sectors;
    for(i = 0; i < numsectors; i++, ss++, ms++)
    {
@@ -178,6 +176,7 @@ void P_LoadSectors(int lump)
       ss->tag        = LITTLESHORT(ms->tag);
       ss->thinglist  = NULL;
    }
+   W_CloseLumpView(&view);
 }
 
 
@@ -191,17 +190,15 @@ void P_LoadSectors(int lump)
 
 void P_LoadNodes(int lump)
 {
-   byte *data;
-   int   i, j, k;
-   mapnode_t *mn;
-   node_t    *no;
+   lumpview_t view;
+   int        i, j, k;
+   const mapnode_t *mn;
+   node_t          *no;
 
    numnodes = W_LumpLength(lump) / sizeof(mapnode_t);
    nodes    = Z_Malloc(numnodes * sizeof(node_t), PU_LEVEL, 0);
-   data     = I_TempBuffer();
-   W_ReadLump(lump, data);
 
-   mn = (mapnode_t *)data;
+   mn = W_OpenLumpView(lump, &view); // CALICO
    no = nodes;
    for(i = 0; i < numnodes; i++, no++, mn++)
    {
@@ -217,6 +214,7 @@ void P_LoadNodes(int lump)
             no->bbox[j][k] = LITTLESHORT(mn->bbox[j][k]) << FRACBITS;
       }
    }
+   W_CloseLumpView(&view);
 }
 
 /*
@@ -229,25 +227,26 @@ void P_LoadNodes(int lump)
 
 void P_LoadThings(int lump)
 {
-   byte *data;
-   int   i;
-   mapthing_t *mt;
+   lumpview_t view;
+   int        i;
+   const mapthing_t *mt;
+   mapthing_t        mthing;
    int numthings;
 
-   data = I_TempBuffer();
-   W_ReadLump(lump, data);
    numthings = W_LumpLength(lump) / sizeof(mapthing_t);
 
-   mt = (mapthing_t *)data;
+   // CALICO: the view is read-only, so swap each thing into a copy
+   mt = W_OpenLumpView(lump, &view);
    for(i = 0; i < numthings; i++, mt++)
    {
-      mt->x       = LITTLESHORT(mt->x);
-      mt->y       = LITTLESHORT(mt->y);
-      mt->angle   = LITTLESHORT(mt->angle);
-      mt->type    = LITTLESHORT(mt->type);
-      mt->options = LITTLESHORT(mt->options);
-      P_SpawnMapThing(mt);
+      mthing.x       = LITTLESHORT(mt->x);
+      mthing.y       = LITTLESHORT(mt->y);
+      mthing.angle   = LITTLESHORT(mt->angle);
+      mthing.type    = LITTLESHORT(mt->type);
+      mthing.options = LITTLESHORT(mt->options);
+      P_SpawnMapThing(&mthing);
    }
+   W_CloseLumpView(&view);
 }
 
 /*
@@ -261,19 +260,17 @@ void P_LoadThings(int lump)
 
 void P_LoadLineDefs(int lump)
 {
-   byte *data;
-   int   i;
-   maplinedef_t *mld;
-   line_t       *ld;
-   vertex_t     *v1, *v2;
+   lumpview_t view;
+   int        i;
+   const maplinedef_t *mld;
+   line_t             *ld;
+   vertex_t           *v1, *v2;
 
    numlines = W_LumpLength(lump) / sizeof(maplinedef_t);
    lines    = Z_Malloc(numlines * sizeof(line_t), PU_LEVEL, 0);
    D_memset(lines, 0, numlines * sizeof(line_t));
-   data     = I_TempBuffer();
-   W_ReadLump(lump, data);
 
-   mld = (maplinedef_t *)data;
+   mld = W_OpenLumpView(lump, &view); // CALICO
    ld = lines;
    for(i = 0; i < numlines; i++, mld++, ld++)
    {
@@ -332,6 +329,7 @@ void P_LoadLineDefs(int lump)
       else
          ld->backsector = 0;
    }
+   W_CloseLumpView(&view);
 }
 
 /*
@@ -344,10 +342,10 @@ void P_LoadLineDefs(int lump)
 
 void P_LoadSideDefs(int lump)
 {
-   byte *data;
-   int   i;
-   mapsidedef_t *msd;
-   side_t       *sd;
+   lumpview_t view;
+   int        i;
+   const mapsidedef_t *msd;
+   side_t             *sd;
 
    for(i = 0; i < numtextures; i++)
       textures[i].usecount = 0;
@@ -355,10 +353,8 @@ void P_LoadSideDefs(int lump)
    numsides = W_LumpLength(lump) / sizeof(mapsidedef_t);
    sides    = Z_Malloc(numsides * sizeof(side_t), PU_LEVEL, 0);
    D_memset(sides, 0, numsides * sizeof(side_t));
-   data     = I_TempBuffer();
-   W_ReadLump(lump, data);
 
-   msd = (mapsidedef_t *)data;
+   msd = W_OpenLumpView(lump, &view); // CALICO
    sd  = sides;
    for(i = 0; i < numsides; i++, msd++, sd++)
    {
@@ -373,6 +369,7 @@ void P_LoadSideDefs(int lump)
       textures[sd->bottomtexture].usecount++;
       textures[sd->midtexture].usecount++;
    }
+   W_CloseLumpView(&view);
 }
 
 /*
@@ -388,11 +385,15 @@ void P_LoadBlockMap(int lump)
    int count;
    int i;
 
-   blockmaplump = W_CacheLumpNum(lump, PU_LEVEL);
+   // CALICO: use the fast-load cache's native copy in place if it has one
+   if((blockmaplump = (short *)W_CacheFind(lump, WC_BLOCKMAP, NULL)) == NULL)
+   {
+      blockmaplump = W_CacheLumpNum(lump, PU_LEVEL);
+      count = W_LumpLength(lump) / 2;
+      for(i = 0; i < count; i++)
+         blockmaplump[i] = LITTLESHORT(blockmaplump[i]);
+   }
    blockmap = blockmaplump + 4;
-   count = W_LumpLength(lump) / 2;
-   for(i = 0; i < count; i++)
-      blockmaplump[i] = LITTLESHORT(blockmaplump[i]);
 
    bmaporgx   = blockmaplump[0] << FRACBITS;
    bmaporgy   = blockmaplump[1] << FRACBITS;
@@ -412,19 +413,24 @@ void P_LoadBlockMap(int lump)
 =
 = Builds sector line lists and subsector sector numbers
 = Finds block bounding boxes for sectors
+=
+= CALICO: rewritten as a counting pass followed by a single scatter pass
+= over the lines, rather than scanning every line for every sector. Lines
+= are still added to each sector in ascending order, so the line lists and
+= bounding boxes are identical to those built by the original code.
 =================
 */
 
 void P_GroupLines(void)
 {
    line_t      **linebuffer;
-   int           i, j, total;
+   int           i, total;
    doom_sector_t     *sector;
    subsector_t  *ss;
    seg_t        *seg;
    int           block;
    line_t       *li;
-   fixed_t       bbox[4];
+   fixed_t      *bboxes, *bbox;
 
    // look up sector number for each subsector
    ss = subsectors;
@@ -448,26 +454,44 @@ void P_GroupLines(void)
       }
    }
 
-   // build line tables for each sector
+   // carve the line buffer up between the sectors; linecount is rebuilt
+   // as a fill index by the scatter pass below
    linebuffer = Z_Malloc(total * sizeof(*linebuffer), PU_LEVEL, 0); // CALICO: use proper sizeof
+   bboxes     = Z_Malloc(numsectors * 4 * sizeof(*bboxes), PU_STATIC, 0);
    sector = sectors;
-   for(i = 0; i < numsectors; i++, sector++)
+   bbox   = bboxes;
+   for(i = 0; i < numsectors; i++, sector++, bbox += 4)
    {
       M_ClearBox(bbox);
       sector->lines = linebuffer;
-      li = lines;
-      for(j = 0; j < numlines; j++, li++)
+      linebuffer += sector->linecount;
+      sector->linecount = 0;
+   }
+
+   // scatter each line into the sector(s) it borders
+   li = lines;
+   for(i = 0; i < numlines; i++, li++)
+   {
+      sector = li->frontsector;
+      sector->lines[sector->linecount++] = li;
+      bbox = &bboxes[(sector - sectors) * 4];
+      M_AddToBox(bbox, li->v1->x, li->v1->y);
+      M_AddToBox(bbox, li->v2->x, li->v2->y);
+
+      sector = li->backsector;
+      if(sector && sector != li->frontsector)
       {
-         if(li->frontsector == sector || li->backsector == sector)
-         {
-            *linebuffer++ = li;
-            M_AddToBox(bbox, li->v1->x, li->v1->y);
-            M_AddToBox(bbox, li->v2->x, li->v2->y);
-         }
+         sector->lines[sector->linecount++] = li;
+         bbox = &bboxes[(sector - sectors) * 4];
+         M_AddToBox(bbox, li->v1->x, li->v1->y);
+         M_AddToBox(bbox, li->v2->x, li->v2->y);
       }
-      if(linebuffer - sector->lines != sector->linecount)
-         I_Error("P_GroupLines: miscounted");
+   }
 
+   sector = sectors;
+   bbox   = bboxes;
+   for(i = 0; i < numsectors; i++, sector++, bbox += 4)
+   {
       // set the degenmobj_t to the middle of the bounding box
       sector->soundorg.x = (bbox[BOXRIGHT] + bbox[BOXLEFT  ]) / 2;
       sector->soundorg.y = (bbox[BOXTOP  ] + bbox[BOXBOTTOM]) / 2;
@@ -489,6 +513,78 @@ void P_GroupLines(void)
       block = block < 0 ? 0 : block;
       sector->blockbox[BOXLEFT] = block;
    }
+
+   Z_Free(bboxes);
+}
+
+//=============================================================================
+
+//
+// CALICO: level load timing instrumentation
+//
+
+enum
+{
+   LT_BLOCKMAP,
+   LT_VERTEXES,
+   LT_SECTORS,
+   LT_SIDEDEFS,
+   LT_LINEDEFS,
+   LT_SSECTORS,
+   LT_NODES,
+   LT_SEGS,
+   LT_REJECT,
+   LT_GROUPLINES,
+   LT_THINGS,
+   LT_SPECIALS,
+   NUMLOADTIMES
+};
+
+static const char *loadtimenames[NUMLOADTIMES] =
+{
+   "BlockMap",
+   "Vertexes",
+   "Sectors",
+   "SideDefs",
+   "LineDefs",
+   "SSectors",
+   "Nodes",
+   "Segs",
+   "Reject",
+   "GroupLines",
+   "Things",
+   "Specials"
+};
+
+int loadtimes[NUMLOADTIMES]; // milliseconds spent in each step of the last P_SetupLevel
+int loadtotaltime;           // milliseconds spent in the whole of the last P_SetupLevel
+
+//
+// Charge the time elapsed since *mark to the given step, and restart the mark
+//
+static void P_MarkLoadTime(int step, int *mark)
+{
+   int now = I_GetTimeMS();
+
+   loadtimes[step] = now - *mark;
+   *mark = now;
+}
+
+extern boolean debugscreenactive;
+
+//
+// Print the load timings to the debug screen
+//
+static void P_PrintLoadTimes(void)
+{
+   int i;
+
+   if(!debugscreenactive)
+      return;
+
+   for(i = 0; i < NUMLOADTIMES; i++)
+      D_printf("%s: %i ms\n", loadtimenames[i], loadtimes[i]);
+   D_printf("P_SetupLevel: %i ms\n", loadtotaltime);
 }
 
 //=============================================================================
@@ -527,6 +623,9 @@ void P_SetupLevel(int map, skill_t skill)
    int          lumpnum;
    mobj_t      *mobj;
    extern int   cy;
+   int          mark, start; // CALICO: load timing
+
+   start = I_GetTimeMS();
 
    M_ClearRandom();
 
@@ -543,7 +642,11 @@ void P_SetupLevel(int map, skill_t skill)
 
    Z_FreeTags(mainzone);
 
+   W_FinishPrefetch(map); // CALICO: collect anything decoded in the background
+
    P_InitThinkers();
+   P_InitSecNodes(); // CALICO
+   P_InitDormant();  // CALICO
 
    //
    // look for a regular (development) map first
@@ -558,18 +661,29 @@ void P_SetupLevel(int map, skill_t skill)
    lumpnum = W_GetNumForName(lumpname);
 
    // note: most of this ordering is important
+   mark = I_GetTimeMS();
    P_LoadBlockMap(lumpnum+ML_BLOCKMAP);
+   P_MarkLoadTime(LT_BLOCKMAP, &mark);
    P_LoadVertexes(lumpnum+ML_VERTEXES);
+   P_MarkLoadTime(LT_VERTEXES, &mark);
    P_LoadSectors(lumpnum+ML_SECTORS);
+   P_MarkLoadTime(LT_SECTORS, &mark);
    P_LoadSideDefs(lumpnum+ML_SIDEDEFS);
+   P_MarkLoadTime(LT_SIDEDEFS, &mark);
    P_LoadLineDefs(lumpnum+ML_LINEDEFS);
+   P_MarkLoadTime(LT_LINEDEFS, &mark);
    P_LoadSubsectors(lumpnum+ML_SSECTORS);
+   P_MarkLoadTime(LT_SSECTORS, &mark);
    P_LoadNodes(lumpnum+ML_NODES);
+   P_MarkLoadTime(LT_NODES, &mark);
    P_LoadSegs(lumpnum+ML_SEGS);
+   P_MarkLoadTime(LT_SEGS, &mark);
 
    rejectmatrix = W_CacheLumpNum(lumpnum + ML_REJECT, PU_LEVEL);
+   P_MarkLoadTime(LT_REJECT, &mark);
 
    P_GroupLines();
+   P_MarkLoadTime(LT_GROUPLINES, &mark);
 
    deathmatch_p = deathmatchstarts;
    P_LoadThings(lumpnum + ML_THINGS);
@@ -591,11 +705,16 @@ void P_SetupLevel(int map, skill_t skill)
          }
       }
    }
+   P_MarkLoadTime(LT_THINGS, &mark);
 
    // set up world state
    P_SpawnSpecials();
+   P_MarkLoadTime(LT_SPECIALS, &mark);
    ST_InitEveryLevel();
 
+   loadtotaltime = I_GetTimeMS() - start;
+   P_PrintLoadTimes();
+
    cy = 4;
 
    iquehead = iquetail = 0;
@@ -21,6 +21,10 @@ animdef_t animdefs[] =
 
 anim_t anims[MAXANIMS], *lastanim;
 
+anim_t *animschedule[MAXANIMS];
+int     numanimschedule;
+static int animstep;
+
 void P_InitPicAnims(void)
 {
    int		i;
@@ -48,6 +52,17 @@ void P_InitPicAnims(void)
       lastanim->numpics = lastanim->picnum - lastanim->basepic + 1;
       lastanim++;
    }
+
+   // CALICO: precompute the animation schedule. Every anim advances on the
+   // same tics, so the frame each shows depends only on how many steps have
+   // been taken; anims with a single frame never change and are left out.
+   numanimschedule = 0;
+   animstep = 0;
+   for(i = 0; i < lastanim - anims; i++)
+   {
+      if(anims[i].numpics > 1)
+         animschedule[numanimschedule++] = &anims[i];
+   }
 }
 
 /*
@@ -641,20 +656,21 @@ void P_PlayerInSpecialSector (player_t *player)
 
 void P_UpdateSpecials(void)
 {
-   anim_t *anim;
-   int     i;
-   line_t *line;
+   anim_t   *anim;
+   int       i, j;
+   button_t *button;
 
    /* */
    /* ANIMATE FLATS AND TEXTURES GLOBALY */
    /* */
    if(!(gametic&3))
    {
-      for(anim = anims; anim < lastanim; anim++)
+      // CALICO: step the precomputed schedule
+      animstep++;
+      for(i = 0; i < numanimschedule; i++)
       {
-         anim->current++;
-         if(anim->current > anim->picnum)
-            anim->current = anim->basepic;
+         anim = animschedule[i];
+         anim->current = anim->basepic + animstep % anim->numpics;
          flattranslation[anim->picnum] = anim->current;
       }
    }
@@ -662,43 +678,42 @@ void P_UpdateSpecials(void)
    /* */
    /*	ANIMATE LINE SPECIALS */
    /* */
+   // CALICO: the list only ever holds EFFECT FIRSTCOL SCROLL+ lines
    for(i = 0; i < numlinespecials; i++)
-   {
-      line = linespeciallist[i];
-      switch(line->special)
-      {
-      case 48:	/* EFFECT FIRSTCOL SCROLL + */
-         sides[line->sidenum[0]].textureoffset += FRACUNIT;
-         break;
-      }
-   }
+      sides[linespeciallist[i]->sidenum[0]].textureoffset += FRACUNIT;
 	
    /* */
    /*	DO BUTTONS */
    /* */
-   for(i = 0; i < MAXBUTTONS; i++)
+   // CALICO: only visit buttons that are running
+   for(i = 0; i < numactivebuttons; )
    {
-      if(buttonlist[i].btimer)
+      button = activebuttons[i];
+      if(--button->btimer)
       {
-         buttonlist[i].btimer--;
-         if(!buttonlist[i].btimer)
-         {
-            switch(buttonlist[i].where)
-            {
-            case top:
-               sides[buttonlist[i].line->sidenum[0]].toptexture = buttonlist[i].btexture;
-               break;
-            case middle:
-               sides[buttonlist[i].line->sidenum[0]].midtexture = buttonlist[i].btexture;
-               break;
-            case bottom:
-               sides[buttonlist[i].line->sidenum[0]].bottomtexture = buttonlist[i].btexture;
-               break;
-            }
-            S_StartSound((mobj_t *)&buttonlist[i].soundorg, sfx_swtchn);
-            D_memset(&buttonlist[i], 0, sizeof(button_t));
-         }
+         i++;
+         continue;
       }
+
+      switch(button->where)
+      {
+      case top:
+         sides[button->line->sidenum[0]].toptexture = button->btexture;
+         break;
+      case middle:
+         sides[button->line->sidenum[0]].midtexture = button->btexture;
+         break;
+      case bottom:
+         sides[button->line->sidenum[0]].bottomtexture = button->btexture;
+         break;
+      }
+      S_StartSound((mobj_t *)&button->soundorg, sfx_swtchn);
+      D_memset(button, 0, sizeof(button_t));
+
+      // drop it from the active list, keeping the rest in order
+      numactivebuttons--;
+      for(j = i; j < numactivebuttons; j++)
+         activebuttons[j] = activebuttons[j+1];
    }
 }
 
@@ -845,6 +860,8 @@ void P_SpawnSpecials(void)
       switch(lines[i].special)
       {
       case 48:	/* EFFECT FIRSTCOL SCROLL+ */
+         if(numlinespecials == MAXLINEANIMS) // CALICO: check for overflow
+            I_Error("P_SpawnSpecials: too many scrolling lines");
          linespeciallist[numlinespecials] = &lines[i];
          numlinespecials++;
          break;
@@ -860,6 +877,7 @@ void P_SpawnSpecials(void)
       activeplats[i] = NULL;
    for(i = 0; i < MAXBUTTONS; i++)
       D_memset(&buttonlist[i], 0, sizeof(button_t));
+   numactivebuttons = 0; // CALICO
 }
 
 // EOF
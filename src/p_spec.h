@@ -38,6 +38,10 @@ typedef struct
 
 extern anim_t anims[MAXANIMS], *lastanim;
 
+/* CALICO: anims that actually cycle, stepped together by P_UpdateSpecials */
+extern anim_t *animschedule[MAXANIMS];
+extern int     numanimschedule;
+
 /* */
 /* Animating line specials */
 /* */
@@ -169,6 +173,10 @@ typedef struct
 
 extern button_t buttonlist[MAXBUTTONS];	
 
+/* CALICO: buttons with a running timer, in the order they were pressed */
+extern button_t *activebuttons[MAXBUTTONS];
+extern int       numactivebuttons;
+
 void P_ChangeSwitchTexture(line_t *line,int useAgain);
 void P_InitSwitchList(void);
 
@@ -21,6 +21,9 @@ int      switchlist[MAXSWITCHES * 2];
 int      numswitches;
 button_t buttonlist[MAXBUTTONS];
 
+button_t *activebuttons[MAXBUTTONS]; // CALICO: buttons with a running timer
+int       numactivebuttons;
+
 /*
 ===============
 =
@@ -71,6 +74,7 @@ void P_StartButton(line_t *line, bwhere_e w, int texture, int time)
          buttonlist[i].btexture = texture;
          buttonlist[i].btimer = time;
          buttonlist[i].soundorg = (mobj_t *)&line->frontsector->soundorg;
+         activebuttons[numactivebuttons++] = &buttonlist[i]; // CALICO
          return;
       }
    }
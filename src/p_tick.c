@@ -310,6 +310,8 @@ int P_Ticker(void)
    P_RunThinkers();
    //thinkertics = samplecount - start;
 
+   P_CheckDormantWake(); // CALICO
+
    //start = samplecount;
    P_CheckSights();
    //sighttics = samplecount - start;
@@ -29,6 +29,7 @@
 #if defined(__unix__) || defined(__linux__) || defined(__APPLE__)
 
 #include <unistd.h>
+#include <sys/mman.h>
 #include <sys/stat.h>
 #include <sys/types.h>
 
@@ -140,6 +141,32 @@ static hal_bool POSIX_FileExists(const char *path)
     return HAL_FALSE;
 }
 
+//
+// Map an entire open file into memory read-only. The mapping stays valid
+// after the file is closed. Returns nullptr if the file can't be mapped.
+//
+static void *POSIX_MapFile(FILE *f, size_t *size)
+{
+   struct stat st;
+   void *data;
+   int fd = fileno(f);
+
+   if(fd < 0 || fstat(fd, &st) || st.st_size <= 0)
+      return nullptr;
+
+   data = mmap(nullptr, size_t(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+   if(data == MAP_FAILED)
+      return nullptr;
+
+   *size = size_t(st.st_size);
+   return data;
+}
+
+static void POSIX_UnmapFile(void *data, size_t size)
+{
+   munmap(data, size);
+}
+
 //
 // Populate the HAL platform interface with POSIX implementation function pointers
 //
@@ -151,6 +178,8 @@ void POSIX_InitHAL(void)
    hal_platform.setIcon     = POSIX_SetIcon;
    hal_platform.fileOpen    = POSIX_FileOpen;
    hal_platform.fileExists  = POSIX_FileExists;
+   hal_platform.mapFile     = POSIX_MapFile;
+   hal_platform.unmapFile   = POSIX_UnmapFile;
 }
 
 #endif
@@ -118,12 +118,14 @@ void R_InitData(void)
 /*
 ================
 =
-= R_FlatNumForName
+= R_CheckFlatNumForName
+=
+= CALICO: split from R_FlatNumForName; returns -1 if not found
 =
 ================
 */
 
-int R_FlatNumForName(const char *name)
+int R_CheckFlatNumForName(const char *name)
 {
    int         i, c;
    lumpinfo_t *lump_p;
@@ -147,11 +149,28 @@ int R_FlatNumForName(const char *name)
          return i;
    }
 
-   // CALICO: don't print more than 8 characters
-   I_Error("R_FlatNumForName: %.8s not found", name);
    return -1;
 }
 
+/*
+================
+=
+= R_FlatNumForName
+=
+================
+*/
+
+int R_FlatNumForName(const char *name)
+{
+   int i;
+
+   i = R_CheckFlatNumForName(name);
+   if(i == -1)
+      I_Error("R_FlatNumForName: %.8s not found", name); // CALICO: don't print more than 8 characters
+
+   return i;
+}
+
 /*
 ================
 =
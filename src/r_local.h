@@ -70,6 +70,8 @@ typedef struct
    void   *specialdata;                 // thinker_t for reversable actions
    VINT    linecount;
    struct line_s **lines;               // [linecount] size
+
+   struct msecnode_s *touching_thinglist; // CALICO: things touching this sector
 } doom_sector_t;
 
 typedef struct
@@ -206,6 +208,7 @@ int  R_PointOnSide(int x, int y, node_t *node);
 int  SlopeDiv(unsigned int num, unsigned int den);
 void R_RenderBSPNode(int bspnum);
 void R_InitData(void);
+void R_DecodeLumpPixels(int lumpnum, pixel_t *dest); // CALICO
 void R_InitSpriteDefs(char **namelist);
 
 // to get a global angle from cartesian coordinates, the coordinates are
@@ -229,6 +229,8 @@ extern int tictics;
 
 extern int soundtics;
 
+extern int dormantskipped; // CALICO
+
 /*
 ===================
 =
@@ -239,6 +241,8 @@ extern int soundtics;
 
 void R_DebugScreen(void)
 {
+   static int lastskipped = -1;
+
 #if 0
    PrintNumber(15, 1, vblsinframe);
 
@@ -252,6 +256,15 @@ void R_DebugScreen(void)
    PrintNumber(15, 9, basetics);
    PrintNumber(15, 10, latetics);
 #endif
+
+   // CALICO: monster thinkers skipped by dormant scheduling; only redrawn
+   // on change, as every print is echoed to the debug output as well
+   if(dormantparm && dormantskipped != lastskipped)
+   {
+      lastskipped = dormantskipped;
+      I_Print8(1, 1, "DORMANT");
+      PrintNumber(9, 1, dormantskipped);
+   }
 }
 
 //=============================================================================
@@ -191,7 +191,7 @@ static void R_FinishSprite(vissprite_t *vis)
 
    // get column headers
    lump  = vis->patchnum;                                // CALICO: use patchnum to avoid type punning
-   patch = wadfileptr + BIGLONG(lumpinfo[lump].filepos); // CALICO: requires endianness correction
+   patch = lumpbase[lump] + BIGLONG(lumpinfo[lump].filepos); // CALICO: requires endianness correction
    vis->patch = (patch_t *)patch;
   
    // column pixel data is in the next lump
@@ -248,7 +248,7 @@ static void R_FinishPSprite(vissprite_t *vis)
 
    // get column headers
    lump  = vis->patchnum;                                // CALICO: use patchnum to avoid type punning
-   patch = wadfileptr + BIGLONG(lumpinfo[lump].filepos); // CALICO: requires endianness correction throughout
+   patch = lumpbase[lump] + BIGLONG(lumpinfo[lump].filepos); // CALICO: requires endianness correction throughout
    vis->patch = (patch_t *)patch;
 
    // column pixel data is in the next lump
@@ -4,8 +4,10 @@
   Renderer phase 5 - Graphics caching
 */
 
+#include <string.h>
 #include "doomdef.h"
 #include "r_local.h"
+#include "w_prefetch.h"
 
 // Doom palette to CRY lookup (hardcoded for efficiency on the Jag ASIC?)
 static pixel_t vgatojag[] =
@@ -34,6 +36,25 @@ static void *R_Malloc(int size, void **user)
 {
    int extra;
    memblock_t *start, *rover, *base, *newblock;
+
+   // CALICO: a TLSF refzone purges blocks not used this frame itself
+   if(refzone->allocator == ZA_TLSF)
+   {
+      void *ptr;
+
+      if(!(ptr = Z_TryMalloc(refzone, size, PU_CACHE, user)))
+      {
+         // everything was used this frame; try again counting it as the last
+         ++framecount;
+         if(!(ptr = Z_TryMalloc(refzone, size, PU_CACHE, user)))
+            I_Error("R_Malloc: failed on %i", size);
+      }
+
+      base = (memblock_t *)((byte *)ptr - sizeof(memblock_t));
+      base->lockframe = framecount; // mark as in use for this frame
+
+      return ptr;
+   }
   
    //
    // scan through the block list looking for the first free block
@@ -126,44 +147,55 @@ backtostart:
    return (void *)((byte *)base + sizeof(memblock_t));
 }
 
-#define LENSHIFT 4 // this must be log2(LOOKAHEAD_SIZE)
-
 //
-// Decompress an lzss-compressed lump
+// CALICO: expand 8-bit palette indices to 16-bit CRY, eight at a time.
+// Each group is read in full before any of it is written, so src may be
+// the top half of dest's own buffer.
 //
-static void R_decode(byte *input, pixel_t *output)
+static void R_ExpandCRY(const byte *src, pixel_t *dest, int count)
 {
-   int getidbyte = 0;
-   int len;
-   int pos;
+   pixel_t p0, p1, p2, p3, p4, p5, p6, p7;
    int i;
-   pixel_t *source;
-   int idbyte = 0;
 
-   while(1)
+   for(i = 0; i + 8 <= count; i += 8)
    {
-      // get a new idbyte if necessary
-      if(!getidbyte)
-         idbyte = *input++;
-      getidbyte = (getidbyte + 1) & 7;
-
-      if(idbyte&1)
-      {
-         // decompress
-         pos = *input++ << LENSHIFT;
-         pos = pos | (*input >> LENSHIFT);
-         source = output - pos - 1;
-         len = (*input++ & 0xf)+1;
-         if(len == 1)
-            break;
-         for(i = 0; i < len; i++)
-            *output++ = *source++;
-      } 
-      else 
-         *output++ = vgatojag[*input++];
-
-      idbyte = idbyte >> 1;
+      p0 = vgatojag[src[i+0]];
+      p1 = vgatojag[src[i+1]];
+      p2 = vgatojag[src[i+2]];
+      p3 = vgatojag[src[i+3]];
+      p4 = vgatojag[src[i+4]];
+      p5 = vgatojag[src[i+5]];
+      p6 = vgatojag[src[i+6]];
+      p7 = vgatojag[src[i+7]];
+      dest[i+0] = p0;
+      dest[i+1] = p1;
+      dest[i+2] = p2;
+      dest[i+3] = p3;
+      dest[i+4] = p4;
+      dest[i+5] = p5;
+      dest[i+6] = p6;
+      dest[i+7] = p7;
    }
+
+   for(; i < count; i++)
+      dest[i] = vgatojag[src[i]];
+}
+
+//
+// Decompress an lzss-compressed lump
+//
+// CALICO: the lump is decoded as bytes into the top half of the output
+// buffer with W_Decode, then expanded to CRY in place, rather than
+// translating each pixel as it is decoded. Back references work the same
+// on indices as on the colors they map to.
+//
+static void R_decode(byte *input, pixel_t *output, int count)
+{
+   byte *pixels = (byte *)output + count;
+   int   decoded;
+
+   decoded = W_Decode(input, pixels);
+   R_ExpandCRY(pixels, output, decoded < count ? decoded : count);
 }
 
 //
@@ -187,10 +219,17 @@ static pixel_t *R_LoadPixels(int lumpnum)
    // allocate at doubled lump size, as translates from 8-bit paletted to 
    // 16-bit CRY while decompressing
    rdest = R_Malloc(count * 2, &lumpcache[lumpnum]);
-   rsrc  = wadfileptr + BIGLONG(info->filepos); // CALICO: ditto
 
-   // decompress
-   R_decode(rsrc, rdest);
+   // CALICO: copy it ready-made from the fast-load cache if it's there
+   if((rsrc = (byte *)W_CacheFind(lumpnum, WC_CRY, NULL)))
+      memcpy(rdest, rsrc, count * 2);
+   else if(!W_PrefetchCopy(lumpnum, WC_CRY, rdest, count * 2)) // or from the prefetcher
+   {
+      rsrc = lumpbase[lumpnum] + BIGLONG(info->filepos); // CALICO: ditto
+
+      // decompress
+      R_decode(rsrc, rdest, count);
+   }
 
    lumpcache[lumpnum] = rdest;
 
@@ -250,5 +289,75 @@ void R_Cache(void)
    }
 }
 
+//
+// CALICO: decode a graphic lump to CRY, for building the fast-load cache
+//
+void R_DecodeLumpPixels(int lumpnum, pixel_t *dest)
+{
+   R_decode(lumpbase[lumpnum] + BIGLONG(lumpinfo[lumpnum].filepos), dest,
+      BIGLONG(lumpinfo[lumpnum].size));
+}
+
+//
+// CALICO: decoder benchmark for -benchdecode. Decodes every compressed lump
+// over and over for about a second, first to bytes with W_Decode and then
+// through to CRY with R_decode, and reports each in MB/s of output. Returns
+// the number of compressed lumps, and their total size in bytes.
+//
+int R_BenchDecode(int *bytes, double *bytembs, double *crymbs)
+{
+   int   i, mode, passes, start, elapsed, size, maxsize, count;
+   byte *buffer, *src;
+   double mbs;
+
+   count = maxsize = *bytes = 0;
+   *bytembs = *crymbs = 0.0;
+
+   for(i = 0; i < numlumps; i++)
+   {
+      if(!(lumpinfo[i].name[0] & 0x80))
+         continue;
+      size = BIGLONG(lumpinfo[i].size);
+      if(size > maxsize)
+         maxsize = size;
+      *bytes += size;
+      count++;
+   }
+   if(!count)
+      return 0;
+
+   buffer = Z_Malloc(maxsize * 2, PU_STATIC, NULL);
+
+   for(mode = 0; mode < 2; mode++)
+   {
+      passes = 0;
+      start  = I_GetTimeMS();
+      do
+      {
+         for(i = 0; i < numlumps; i++)
+         {
+            if(!(lumpinfo[i].name[0] & 0x80))
+               continue;
+            src = lumpbase[i] + BIGLONG(lumpinfo[i].filepos);
+            if(mode == 0)
+               W_Decode(src, buffer);
+            else
+               R_decode(src, (pixel_t *)buffer, BIGLONG(lumpinfo[i].size));
+         }
+         passes++;
+      }
+      while((elapsed = I_GetTimeMS() - start) < 1000);
+
+      mbs = (double)*bytes * passes / (1024.0 * 1024.0) / (elapsed / 1000.0);
+      if(mode == 0)
+         *bytembs = mbs;
+      else
+         *crymbs = mbs;
+   }
+
+   Z_Free(buffer);
+   return count;
+}
+
 // EOF
 
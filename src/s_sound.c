@@ -5,6 +5,7 @@
 #include "s_soundfmt.h"  // CALICO
 #include "doomdef.h"
 #include "music.h"
+#include "w_cache.h"
 
 #define EXTERN_BUFFER_SIZE (EXTERNALQUADS*32/2)
 
@@ -76,9 +77,16 @@ void S_Init(void)
          l = W_CheckNumForName(S_sfx[i].name);
          if(l != -1)
          {
+            const void *cached;
+            int         size;
+
             S_sfx[i].md_data = W_POINTLUMPNUM(l);
-            // CALICO: convert to output format
-            S_sfx[i].sample  = SfxSample_LoadFromData(S_sfx[i].name, W_POINTLUMPNUM(l), W_LumpLength(l));
+            // CALICO: convert to output format, unless the fast-load cache
+            // already has it converted
+            if((cached = W_CacheFind(l, WC_FLOAT, &size)))
+               S_sfx[i].sample = SfxSample_LoadFromFloat(S_sfx[i].name, cached, size / sizeof(float));
+            else
+               S_sfx[i].sample = SfxSample_LoadFromData(S_sfx[i].name, W_POINTLUMPNUM(l), W_LumpLength(l));
          }
       }
    }
@@ -227,6 +227,25 @@ PSFXSAMPLE SfxSample_LoadFromData(const char *tag, void *data, size_t len)
    return ret;
 }
 
+//
+// Create a sample from float data that is already at the output samplerate,
+// such as from the fast-load cache. The data is copied.
+//
+PSFXSAMPLE SfxSample_LoadFromFloat(const char *tag, const void *samples, size_t count)
+{
+   SfxSample *ret = nullptr;
+
+   if(!(ret = gSoundManager.findResourceType<SfxSample>(tag)))
+   {
+      float *data = new float [count];
+      std::memcpy(data, samples, count * sizeof(float));
+      ret = new SfxSample(tag, count, data);
+      gSoundManager.addResource(ret);
+   }
+
+   return ret;
+}
+
 PSFXSAMPLE SfxSample_FindByTag(const char *tag)
 {
    return gSoundManager.findResourceType<SfxSample>(tag);
@@ -46,6 +46,7 @@ extern "C" {
 #endif
 
 PSFXSAMPLE SfxSample_LoadFromData(const char *tag, void *data, size_t len);
+PSFXSAMPLE SfxSample_LoadFromFloat(const char *tag, const void *samples, size_t count);
 PSFXSAMPLE SfxSample_FindByTag(const char *tag);
 size_t     SfxSample_GetNumSamples(PCSFXSAMPLE sfx);
 float     *SfxSample_GetSamples(PCSFXSAMPLE sfx);
@@ -33,11 +33,13 @@
 #include "../hal/hal_input.h"
 #include "../hal/hal_ml.h"
 #include "../hal/hal_sfx.h"
+#include "../hal/hal_thread.h"
 #include "../hal/hal_timer.h"
 #include "../hal/hal_video.h"
 #include "sdl_init.h"
 #include "sdl_input.h"
 #include "sdl_sound.h"
+#include "sdl_threads.h"
 #include "sdl_timer.h"
 #include "sdl_video.h"
 
@@ -103,6 +105,11 @@ void SDL2_InitHAL(void)
    hal_timer.delay     = SDL2_Delay;
    hal_timer.getTime   = SDL2_GetTime;
    hal_timer.getTimeMS = SDL2_GetTimeMS;
+   hal_timer.getTimeUS = SDL2_GetTimeUS;
+
+   // Threads
+   hal_thread.createThread = SDL2_CreateThread;
+   hal_thread.waitThread   = SDL2_WaitThread;
 }
 
 #endif
@@ -0,0 +1,59 @@
+/*
+  CALICO
+  
+  SDL 2 Thread Functions
+  
+  The MIT License (MIT)
+  
+  Copyright (c) 2016 James Haley
+  
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+  
+  The above copyright notice and this permission notice shall be included in all
+  copies or substantial portions of the Software.
+  
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+*/
+
+#ifdef USE_SDL2
+
+#include "SDL.h"
+#include "SDL_thread.h"
+#include "sdl_threads.h"
+
+//
+// Start fn running on a new thread. Returns nullptr if the thread could not
+// be created.
+//
+void *SDL2_CreateThread(hal_threadfunc_t fn, const char *name, void *data)
+{
+   return SDL_CreateThread(fn, name, data);
+}
+
+//
+// Wait for a thread to finish and return its result
+//
+int SDL2_WaitThread(void *thread)
+{
+   int status = 0;
+
+   SDL_WaitThread(static_cast<SDL_Thread *>(thread), &status);
+
+   return status;
+}
+
+#endif
+
+// EOF
+
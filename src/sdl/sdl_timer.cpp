@@ -70,6 +70,20 @@ unsigned int SDL2_GetTimeMS(void)
    return ticks - basetime;
 }
 
+//
+// Get time in microseconds from the high-resolution counter
+//
+unsigned int SDL2_GetTimeUS(void)
+{
+   static Uint64 freq;
+   Uint64 count = SDL_GetPerformanceCounter();
+
+   if(!freq)
+      freq = SDL_GetPerformanceFrequency();
+
+   return static_cast<unsigned int>((count / freq) * 1000000 + (count % freq) * 1000000 / freq);
+}
+
 #endif
 
 // EOF
@@ -38,6 +38,7 @@ extern "C" {
 void         SDL2_Delay(unsigned int ms);
 unsigned int SDL2_GetTime(void);
 unsigned int SDL2_GetTimeMS(void);
+unsigned int SDL2_GetTimeUS(void);
 
 #ifdef __cplusplus
 }
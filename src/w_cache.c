@@ -0,0 +1,387 @@
+/*
+  CALICO
+  
+  WAD Fast-Load Cache
+  
+  The MIT License (MIT)
+  
+  Copyright (c) 2016 James Haley
+  
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+  
+  The above copyright notice and this permission notice shall be included in all
+  copies or substantial portions of the Software.
+  
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+*/
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#ifndef YAUL_DOOM
+#include "elib/elib.h"
+#include "elib/m_argv.h"
+#include "elib/misc.h"
+#include "hal/hal_ml.h"
+#include "hal/hal_platform.h"
+#include "hal/hal_sfx.h"
+#endif
+#include "doomdef.h"
+#include "r_local.h"
+#include "s_soundfmt.h"
+#include "w_cache.h"
+#include "w_iwad.h"
+
+//
+// The cache is a file of data preprocessed from the IWAD by -buildcache:
+// decompressed, converted and byte-swapped into native form, so that the
+// game can use it as is. It is memory-mapped at startup and only used if
+// it was built from an identical IWAD image, on a host with the same byte
+// order, by the same version of this code.
+//
+// Layout: a header, then numentries entries, then the data they point to,
+// each piece aligned to WCACHE_ALIGN bytes.
+//
+
+#define WCACHE_VERSION   1
+#define WCACHE_BYTEORDER 0x01020304u
+#define WCACHE_ALIGN     16
+
+typedef struct wcacheheader_s
+{
+   char     magic[8];   // "CALCACHE"
+   uint32_t version;
+   uint32_t byteorder;  // reads differently on a host of the other endianness
+   uint64_t checksum;   // of the IWAD image the cache was built from
+   uint32_t numlumps;   // number of lumps in that IWAD
+   uint32_t samplerate; // output rate WC_FLOAT samples were converted at
+   uint32_t numentries;
+   uint32_t pad;
+} wcacheheader_t;
+
+typedef struct wcacheentry_s
+{
+   uint32_t lump;
+   uint32_t kind;   // wcachekind_e
+   uint32_t offset; // from the start of the file
+   uint32_t size;   // in bytes
+} wcacheentry_t;
+
+static const byte           *cachedata;
+static const wcacheentry_t **cacheindex; // [lump * WC_NUMKINDS + kind]
+static unsigned int          cacherate;
+
+#ifndef YAUL_DOOM
+
+//
+// Checksum of the IWAD image; FNV-1a over 64-bit words, with the high half
+// folded back in so later words affect every bit.
+//
+static uint64_t W_imageChecksum(const byte *data, size_t size)
+{
+   uint64_t h = 14695981039346656037ULL, w;
+   size_t   i;
+
+   for(i = 0; i + 8 <= size; i += 8)
+   {
+      memcpy(&w, data + i, 8);
+      h  = (h ^ w) * 1099511628211ULL;
+      h ^= h >> 32;
+   }
+   for(; i < size; i++)
+      h = (h ^ data[i]) * 1099511628211ULL;
+
+   return h;
+}
+
+//
+// Get the path of the cache file; -cachefile overrides the default of
+// jagdoom.cache in the base directory. Returned string must be efree'd.
+//
+static char *W_cachePath(void)
+{
+   int i;
+
+   if((i = M_GetArgParameters("-cachefile", 1)) != 0)
+      return estrdup(myargv[i]);
+
+   return M_SafeFilePath(hal_medialayer.getBaseDirectory(), "jagdoom.cache");
+}
+
+#endif
+
+//
+// Map the cache file, if there is a valid one for the loaded IWAD. Must be
+// called with only the IWAD's lumps in the directory.
+//
+void W_OpenCache(void)
+{
+#ifndef YAUL_DOOM
+   FILE   *f;
+   char   *path;
+   byte   *data;
+   size_t  size;
+   const wcacheheader_t *header;
+   const wcacheentry_t  *entry;
+   uint32_t i;
+
+   if(M_FindArgument("-nocache") || M_FindArgument("-buildcache") || !hal_platform.mapFile)
+      return;
+
+   path = W_cachePath();
+   f    = hal_platform.fileOpen(path, "rb");
+   efree(path);
+   if(!f)
+      return;
+
+   data = hal_platform.mapFile(f, &size);
+   fclose(f);
+   if(!data)
+      return;
+
+   header = (const wcacheheader_t *)data;
+   if(size < sizeof(*header) ||
+      memcmp(header->magic, "CALCACHE", sizeof(header->magic)) ||
+      header->version   != WCACHE_VERSION   ||
+      header->byteorder != WCACHE_BYTEORDER ||
+      header->numlumps  != (uint32_t)numlumps ||
+      header->numentries > (size - sizeof(*header)) / sizeof(*entry) ||
+      header->checksum  != W_imageChecksum(wadfileptr, W_IWADSize()))
+   {
+      hal_platform.unmapFile(data, size); // stale or foreign
+      return;
+   }
+
+   cacheindex = Z_Malloc(numlumps * WC_NUMKINDS * sizeof(*cacheindex), PU_STATIC, NULL);
+   D_memset(cacheindex, 0, numlumps * WC_NUMKINDS * sizeof(*cacheindex));
+
+   entry = (const wcacheentry_t *)(header + 1);
+   for(i = 0; i < header->numentries; i++, entry++)
+   {
+      if(entry->lump >= (uint32_t)numlumps || entry->kind >= WC_NUMKINDS ||
+         entry->offset > size || entry->size > size - entry->offset)
+         continue;
+      cacheindex[entry->lump * WC_NUMKINDS + entry->kind] = entry;
+   }
+
+   cachedata = data;
+   cacherate = header->samplerate;
+#endif
+}
+
+//
+// Find preprocessed data for a lump. Returns NULL if the cache doesn't
+// have it. If size is not NULL, it receives the size of the data in bytes.
+//
+const void *W_CacheFind(int lump, wcachekind_e kind, int *size)
+{
+   const wcacheentry_t *entry;
+
+   if(!cacheindex || !(entry = cacheindex[lump * WC_NUMKINDS + kind]))
+      return NULL;
+
+#ifndef YAUL_DOOM
+   // samples are only good at the rate they were converted for
+   if(kind == WC_FLOAT && (int)cacherate != hal_sound.getSampleRate())
+      return NULL;
+#endif
+
+   if(size)
+      *size = (int)entry->size;
+   return cachedata + entry->offset;
+}
+
+#ifndef YAUL_DOOM
+
+typedef struct wcachework_s
+{
+   wcacheentry_t  entry;
+   const void    *data;
+   void          *owned; // freed once written
+} wcachework_t;
+
+static wcachework_t *work;
+static int           numwork;
+
+static void *W_addWork(int lump, wcachekind_e kind, size_t size, const void *data)
+{
+   wcachework_t *w = &work[numwork++];
+
+   w->entry.lump = (uint32_t)lump;
+   w->entry.kind = (uint32_t)kind;
+   w->entry.size = (uint32_t)size;
+   if(data)
+   {
+      w->data  = data;
+      w->owned = NULL;
+   }
+   else
+      w->data = w->owned = emalloc(void, size);
+
+   return w->owned;
+}
+
+static void W_freeWork(void)
+{
+   int i;
+
+   for(i = 0; i < numwork; i++)
+      efree(work[i].owned);
+   efree(work);
+   work    = NULL;
+   numwork = 0;
+}
+
+//
+// Write out the header, the entries and their data
+//
+static boolean W_writeCache(FILE *f, size_t *total)
+{
+   static const byte zeroes[WCACHE_ALIGN];
+   wcacheheader_t header;
+   size_t offset, pad;
+   int i;
+
+   memset(&header, 0, sizeof(header));
+   memcpy(header.magic, "CALCACHE", sizeof(header.magic));
+   header.version    = WCACHE_VERSION;
+   header.byteorder  = WCACHE_BYTEORDER;
+   header.checksum   = W_imageChecksum(wadfileptr, W_IWADSize());
+   header.numlumps   = (uint32_t)numlumps;
+   header.samplerate = (uint32_t)hal_sound.getSampleRate();
+   header.numentries = (uint32_t)numwork;
+
+   // lay out the data
+   offset = sizeof(header) + numwork * sizeof(wcacheentry_t);
+   for(i = 0; i < numwork; i++)
+   {
+      offset = (offset + WCACHE_ALIGN - 1) & ~(size_t)(WCACHE_ALIGN - 1);
+      work[i].entry.offset = (uint32_t)offset;
+      offset += work[i].entry.size;
+   }
+   *total = offset;
+
+   if(fwrite(&header, sizeof(header), 1, f) != 1)
+      return false;
+   for(i = 0; i < numwork; i++)
+   {
+      if(fwrite(&work[i].entry, sizeof(wcacheentry_t), 1, f) != 1)
+         return false;
+   }
+
+   offset = sizeof(header) + numwork * sizeof(wcacheentry_t);
+   for(i = 0; i < numwork; i++)
+   {
+      pad = work[i].entry.offset - offset;
+      if(pad && fwrite(zeroes, 1, pad, f) != pad)
+         return false;
+      if(fwrite(work[i].data, 1, work[i].entry.size, f) != work[i].entry.size)
+         return false;
+      offset = work[i].entry.offset + work[i].entry.size;
+   }
+
+   return true;
+}
+
+#endif
+
+//
+// Build the cache file from the loaded IWAD, for -buildcache. Textures,
+// flats and sounds must already have been set up. Fills in msg with a
+// report and returns true on success.
+//
+boolean W_BuildCache(char *msg, size_t msglen)
+{
+#ifndef YAUL_DOOM
+   FILE    *f;
+   char    *path;
+   byte    *iscry, *dest;
+   boolean  ok;
+   size_t   total = 0;
+   int      i, lump, size;
+   short   *bmap;
+   PSFXSAMPLE sample;
+
+   work  = ecalloc(wcachework_t, numlumps * WC_NUMKINDS, sizeof(*work));
+   iscry = ecalloc(byte, numlumps, 1);
+
+   // wall textures and flats, decoded to CRY as R_LoadPixels would
+   for(i = 0; i < numtextures + numflats; i++)
+   {
+      lump = (i < numtextures) ? textures[i].lumpnum : firstflat + i - numtextures;
+      if(lump < 0 || lump >= numlumps || iscry[lump])
+         continue;
+      iscry[lump] = 1;
+      dest = W_addWork(lump, WC_CRY, W_LumpLength(lump) * sizeof(pixel_t), NULL);
+      R_DecodeLumpPixels(lump, (pixel_t *)dest);
+   }
+
+   for(i = 0; i < numlumps; i++)
+   {
+      size = W_LumpLength(i);
+
+      // anything else compressed, decoded
+      if((lumpinfo[i].name[0] & 0x80) && !iscry[i])
+      {
+         dest = W_addWork(i, WC_BYTES, size, NULL);
+         W_ReadLump(i, dest);
+      }
+
+      // blockmaps, byte-swapped as P_LoadBlockMap would
+      if(!W_strncasecmp(lumpinfo[i].name, "BLOCKMAP", 8))
+      {
+         bmap = W_addWork(i, WC_BLOCKMAP, size, NULL);
+         W_ReadLump(i, bmap);
+         for(size /= 2; size > 0; size--, bmap++)
+            *bmap = LITTLESHORT(*bmap);
+      }
+   }
+
+   // sound effects, as already converted by S_Init
+   for(i = 1; i < NUMSFX; i++)
+   {
+      if(!(sample = S_sfx[i].sample) || (lump = W_CheckNumForName(S_sfx[i].name)) == -1)
+         continue;
+      W_addWork(lump, WC_FLOAT, SfxSample_GetNumSamples(sample) * sizeof(float),
+                SfxSample_GetSamples(sample));
+   }
+
+   efree(iscry);
+
+   path = W_cachePath();
+   if((f = hal_platform.fileOpen(path, "wb")))
+   {
+      ok = W_writeCache(f, &total);
+      if(fclose(f))
+         ok = false;
+   }
+   else
+      ok = false;
+
+   if(ok)
+      snprintf(msg, msglen, "Wrote %s: %d entries, %lu bytes", path, numwork, (unsigned long)total);
+   else
+      snprintf(msg, msglen, "Could not write %s", path);
+
+   efree(path);
+   W_freeWork();
+   return ok;
+#else
+   return false;
+#endif
+}
+
+// EOF
+
@@ -0,0 +1,51 @@
+/*
+  CALICO
+  
+  WAD Fast-Load Cache
+  
+  The MIT License (MIT)
+  
+  Copyright (c) 2016 James Haley
+  
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+  
+  The above copyright notice and this permission notice shall be included in all
+  copies or substantial portions of the Software.
+  
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+*/
+
+#ifndef W_CACHE_H__
+#define W_CACHE_H__
+
+//
+// Kinds of preprocessed data held in the cache, each keyed by lump number
+//
+typedef enum wcachekind_e
+{
+   WC_BYTES,    // LZSS-compressed lump, decoded
+   WC_CRY,      // wall texture or flat, decoded and expanded to 16-bit CRY
+   WC_FLOAT,    // sound effect, converted to float at the cache's samplerate
+   WC_BLOCKMAP, // BLOCKMAP lump in native byte order
+   WC_NUMKINDS
+} wcachekind_e;
+
+void        W_OpenCache(void);
+const void *W_CacheFind(int lump, wcachekind_e kind, int *size);
+boolean     W_BuildCache(char *msg, size_t msglen);
+
+#endif
+
+// EOF
+
@@ -196,6 +196,74 @@ static wfiletype_e W_checkFileFormat(FILE *f, long *offset)
    }
 }
 
+#ifndef YAUL_DOOM
+//
+// CALICO: find the last "IWAD" in a mapped file, memrchr-style
+//
+static const byte *W_findLastIWAD(const byte *data, size_t size)
+{
+   size_t i;
+
+   if(size < 4)
+      return NULL;
+
+   for(i = size - 3; i-- > 0; )
+   {
+      if(data[i] == 'I' && data[i + 1] == 'W' && data[i + 2] == 'A' && data[i + 3] == 'D')
+         return data + i;
+   }
+
+   return NULL;
+}
+
+//
+// CALICO: determine the format of a mapped file without reading it through
+//
+static wfiletype_e W_checkMappedFormat(const byte *data, size_t size, long *offset)
+{
+   const byte *id;
+
+   if(size >= 4 && !memcmp(data, "IWAD", 4))
+   {
+      *offset = 0;
+      return WFT_WAD;
+   }
+
+   if((id = W_findLastIWAD(data, size)))
+   {
+      *offset = (long)(id - data);
+      return WFT_ROM;
+   }
+
+   return WFT_UNKNOWN;
+}
+
+//
+// CALICO: map the WAD file instead of reading it, so that lumps are paged
+// in by the OS as they are touched. Returns NULL if mapping isn't available,
+// in which case the file is read into memory as usual.
+//
+static byte *W_mapWADFile(FILE *f, wfiletype_e *type, size_t *length)
+{
+   byte  *data;
+   size_t size;
+   long   offset = 0;
+
+   if(!hal_platform.mapFile || !(data = hal_platform.mapFile(f, &size)))
+      return NULL;
+
+   *type = W_checkMappedFormat(data, size, &offset);
+   if(*type != WFT_WAD && *type != WFT_ROM)
+   {
+      hal_platform.unmapFile(data, size);
+      return NULL;
+   }
+
+   *length = size - offset;
+   return data + offset;
+}
+#endif
+
 //
 // Read the WAD file into memory
 //
@@ -222,6 +290,8 @@ static byte *W_cacheWADFile(FILE *f, long offset)
    return buffer + offset;
 }
 
+static size_t iwadsize; // CALICO: bytes from the IWAD header to the end of file
+
 //
 // Load the IWAD
 //
@@ -244,14 +314,87 @@ byte *W_LoadIWAD(void)
       }
    }
 
+#ifndef YAUL_DOOM
+   // CALICO: try to map it first
+   if((data = W_mapWADFile(f, &type, &iwadsize)))
+   {
+      fclose(f);
+      return data;
+   }
+   rewind(f);
+#endif
+
    // check format of opened file
    type = W_checkFileFormat(f, &offset);
    if(type == WFT_WAD || type == WFT_ROM)
-      data = W_cacheWADFile(f, offset);
+   {
+      if((data = W_cacheWADFile(f, offset)))
+         iwadsize = (size_t)(ftell(f) - offset);
+   }
 
    fclose(f);
    return data;
 }
 
+//
+// CALICO: size of the loaded IWAD image, from its header to the end of file
+//
+size_t W_IWADSize(void)
+{
+   return iwadsize;
+}
+
+//
+// CALICO: map or read a PWAD into memory
+//
+static byte *W_loadPWADFile(const char *path, size_t *size)
+{
+   FILE *f;
+   byte *data = NULL;
+   char  id[4];
+   long  length;
+
+   if(!(f = hal_platform.fileOpen(path, "rb")))
+      return NULL;
+
+   if(fread(id, 1, earrlen(id), f) == earrlen(id) &&
+      (!strncmp(id, "PWAD", earrlen(id)) || !strncmp(id, "IWAD", earrlen(id))) &&
+      !fseek(f, 0, SEEK_END) && (length = ftell(f)) > 0)
+   {
+#ifndef YAUL_DOOM
+      if(!hal_platform.mapFile || !(data = hal_platform.mapFile(f, size)))
+#endif
+      {
+         *size = (size_t)length;
+         data  = W_cacheWADFile(f, 0);
+      }
+   }
+
+   fclose(f);
+   return data;
+}
+
+//
+// CALICO: load each file given to -file, in command line order
+//
+int W_LoadPWADs(byte **files, size_t *sizes, int maxfiles)
+{
+   int i, numfiles = 0;
+
+   if(!(i = M_GetArgParameters("-file", 1)))
+      return 0;
+
+   for(; i < myargc && myargv[i][0] != '-'; i++)
+   {
+      if(numfiles == maxfiles)
+         hal_platform.fatalError("W_LoadPWADs: more than %d files given to -file", maxfiles);
+      if(!(files[numfiles] = W_loadPWADFile(myargv[i], &sizes[numfiles])))
+         hal_platform.fatalError("W_LoadPWADs: could not load %s", myargv[i]);
+      numfiles++;
+   }
+
+   return numfiles;
+}
+
 // EOF
 
@@ -30,6 +30,8 @@
 #define W_IWAD_H__
 
 byte *W_LoadIWAD(void);
+int   W_LoadPWADs(byte **files, size_t *sizes, int maxfiles);
+size_t W_IWADSize(void);
 
 #endif
 
@@ -0,0 +1,358 @@
+/*
+  CALICO
+  
+  Background Lump Prefetch
+  
+  The MIT License (MIT)
+  
+  Copyright (c) 2016 James Haley
+  
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+  
+  The above copyright notice and this permission notice shall be included in all
+  copies or substantial portions of the Software.
+  
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#ifndef YAUL_DOOM
+#include "elib/m_argv.h"
+#include "hal/hal_thread.h"
+#endif
+#include "doomdef.h"
+#include "r_local.h"
+#include "w_prefetch.h"
+
+//
+// While the intermission for one level is running, a worker thread decodes
+// the lumps the next level will want: its compressed map lumps, and the
+// textures, flats and sprites it references, already expanded to CRY.
+// P_SetupLevel waits for the worker and from then on W_ReadLump and
+// R_LoadPixels copy from the results instead of decoding.
+//
+// The worker only reads data that is fixed after startup (the lump
+// directory, the texture and sprite tables) and writes only to its own
+// result table, which the game doesn't look at until it has been waited on.
+// Results are malloc'd rather than zone-allocated, as the zone is not
+// thread-safe. Anything not used by the time of the next prefetch, or that
+// was prefetched for a map other than the one loaded, is thrown away.
+//
+
+#ifndef YAUL_DOOM
+
+static void  *prefetchthread; // worker, while running
+static int    prefetchmap;    // map the results are for, or 0
+static void **prefetchdata;   // [numlumps] decoded lump data, or NULL
+static byte  *prefetchkind;   // [numlumps] wcachekind_e of prefetchdata
+static int    prefetchlumps;  // number of lumps decoded
+static int    prefetchbytes;  // total size of decoded data
+
+//
+// Free every result not yet used
+//
+static void W_discardPrefetch(void)
+{
+   int i;
+
+   if(prefetchdata)
+   {
+      for(i = 0; i < numlumps; i++)
+      {
+         if(prefetchdata[i])
+         {
+            free(prefetchdata[i]);
+            prefetchdata[i] = NULL;
+         }
+      }
+   }
+
+   prefetchmap   = 0;
+   prefetchlumps = 0;
+   prefetchbytes = 0;
+}
+
+//
+// Decode a compressed lump as bytes, unless it is done already or the
+// fast-load cache has it
+//
+static void W_prefetchBytes(int lump)
+{
+   byte *data;
+   int   size;
+
+   if(lump < 0 || prefetchdata[lump] || !(lumpinfo[lump].name[0] & 0x80))
+      return;
+   if(W_CacheFind(lump, WC_BYTES, NULL))
+      return;
+
+   size = BIGLONG(lumpinfo[lump].size);
+   if(!(data = malloc(size)))
+      return;
+
+   W_Decode(lumpbase[lump] + BIGLONG(lumpinfo[lump].filepos), data);
+
+   prefetchdata[lump] = data;
+   prefetchkind[lump] = WC_BYTES;
+   ++prefetchlumps;
+   prefetchbytes += size;
+}
+
+//
+// Decode a graphic lump to CRY as R_LoadPixels would
+//
+static void W_prefetchPixels(int lump)
+{
+   pixel_t *data;
+   int      size;
+
+   if(lump < 0 || lump >= numlumps || prefetchdata[lump])
+      return;
+   if(W_CacheFind(lump, WC_CRY, NULL))
+      return;
+
+   size = BIGLONG(lumpinfo[lump].size) * 2;
+   if(!(data = malloc(size)))
+      return;
+
+   R_DecodeLumpPixels(lump, data);
+
+   prefetchdata[lump] = data;
+   prefetchkind[lump] = WC_CRY;
+   ++prefetchlumps;
+   prefetchbytes += size;
+}
+
+//
+// Get a map lump's data, decoded if it was compressed
+//
+static const void *W_prefetchLumpData(int lump)
+{
+   if(!(lumpinfo[lump].name[0] & 0x80))
+      return lumpbase[lump] + BIGLONG(lumpinfo[lump].filepos);
+   if(prefetchdata[lump])
+      return prefetchdata[lump];
+   return W_CacheFind(lump, WC_BYTES, NULL);
+}
+
+//
+// Every frame of every rotation of a sprite
+//
+static void W_prefetchSprite(int sprite)
+{
+   spritedef_t *sprdef = &sprites[sprite];
+   int          i, j;
+
+   for(i = 0; i < sprdef->numframes; i++)
+   {
+      for(j = 0; j < 8; j++)
+         W_prefetchPixels(sprdef->spriteframes[i].lump[j] + 1);
+   }
+}
+
+//
+// Worker thread
+//
+static int W_prefetchWork(void *data)
+{
+   char                lumpname[8];
+   int                 lumpnum, i, j, count, num;
+   const mapsector_t  *ms;
+   const mapsidedef_t *msd;
+   const mapthing_t   *mt;
+   boolean             spritedone[NUMSPRITES];
+
+   snprintf(lumpname, sizeof(lumpname), "MAP%02d", prefetchmap);
+   if((lumpnum = W_CheckNumForName(lumpname)) == -1)
+      return 0;
+
+   for(i = ML_THINGS; i <= ML_BLOCKMAP; i++)
+      W_prefetchBytes(lumpnum + i);
+
+   // floor and ceiling flats
+   if((ms = W_prefetchLumpData(lumpnum + ML_SECTORS)))
+   {
+      count = W_LumpLength(lumpnum + ML_SECTORS) / sizeof(mapsector_t);
+      for(i = 0; i < count; i++, ms++)
+      {
+         if((num = R_CheckFlatNumForName(ms->floorpic)) != -1)
+            W_prefetchPixels(firstflat + num);
+         if(D_strncasecmp(ms->ceilingpic, "F_SKY1", 6) &&
+            (num = R_CheckFlatNumForName(ms->ceilingpic)) != -1)
+            W_prefetchPixels(firstflat + num);
+      }
+   }
+
+   // wall textures
+   if((msd = W_prefetchLumpData(lumpnum + ML_SIDEDEFS)))
+   {
+      count = W_LumpLength(lumpnum + ML_SIDEDEFS) / sizeof(mapsidedef_t);
+      for(i = 0; i < count; i++, msd++)
+      {
+         if((num = R_CheckTextureNumForName(msd->toptexture)) > 0)
+            W_prefetchPixels(textures[num].lumpnum);
+         if((num = R_CheckTextureNumForName(msd->midtexture)) > 0)
+            W_prefetchPixels(textures[num].lumpnum);
+         if((num = R_CheckTextureNumForName(msd->bottomtexture)) > 0)
+            W_prefetchPixels(textures[num].lumpnum);
+      }
+   }
+
+   // sprites for the things spawned at level start
+   if((mt = W_prefetchLumpData(lumpnum + ML_THINGS)))
+   {
+      memset(spritedone, 0, sizeof(spritedone));
+      count = W_LumpLength(lumpnum + ML_THINGS) / sizeof(mapthing_t);
+      for(i = 0; i < count; i++, mt++)
+      {
+         int type = LITTLESHORT(mt->type);
+
+         for(j = 0; j < NUMMOBJTYPES; j++)
+         {
+            if(mobjinfo[j].doomednum == type)
+            {
+               num = states[mobjinfo[j].spawnstate].sprite;
+               if(!spritedone[num])
+               {
+                  spritedone[num] = true;
+                  W_prefetchSprite(num);
+               }
+               break;
+            }
+         }
+      }
+   }
+
+   return 0;
+}
+
+#endif
+
+/*
+================
+=
+= W_StartPrefetch
+=
+= Start decoding the lumps for a map in the background. -noprefetch turns
+= this off.
+=
+================
+*/
+
+void W_StartPrefetch(int map)
+{
+#ifndef YAUL_DOOM
+   W_FinishPrefetch(0);
+
+   if(!hal_thread.createThread || M_FindArgument("-noprefetch"))
+      return;
+
+   if(!prefetchdata)
+   {
+      prefetchdata = calloc(numlumps, sizeof(*prefetchdata));
+      prefetchkind = calloc(numlumps, sizeof(*prefetchkind));
+      if(!prefetchdata || !prefetchkind)
+         return;
+   }
+
+   prefetchmap    = map;
+   prefetchthread = hal_thread.createThread(W_prefetchWork, "prefetch", NULL);
+   if(!prefetchthread)
+      prefetchmap = 0;
+#endif
+}
+
+/*
+================
+=
+= W_FinishPrefetch
+=
+= Wait for the worker, if it is running, and keep its results only if they
+= are for the given map
+=
+================
+*/
+
+void W_FinishPrefetch(int map)
+{
+#ifndef YAUL_DOOM
+   if(prefetchthread)
+   {
+      hal_thread.waitThread(prefetchthread);
+      prefetchthread = NULL;
+   }
+
+   if(prefetchmap != map)
+      W_discardPrefetch();
+   else if(prefetchmap)
+      D_printf("W_FinishPrefetch: %d lumps, %d bytes\n", prefetchlumps, prefetchbytes);
+#endif
+}
+
+/*
+================
+=
+= W_PrefetchCopy
+=
+= If the lump was prefetched as the given kind of data, copy it to dest,
+= free it, and return true
+=
+================
+*/
+
+boolean W_PrefetchCopy(int lump, wcachekind_e kind, void *dest, int size)
+{
+   void *data;
+
+   if(!(data = W_PrefetchTake(lump, kind)))
+      return false;
+
+   memcpy(dest, data, size);
+   free(data);
+
+   return true;
+}
+
+/*
+================
+=
+= W_PrefetchTake
+=
+= If the lump was prefetched as the given kind of data, hand it over. The
+= caller must free() it.
+=
+================
+*/
+
+void *W_PrefetchTake(int lump, wcachekind_e kind)
+{
+#ifndef YAUL_DOOM
+   void *data;
+
+   if(prefetchthread || !prefetchdata || !prefetchdata[lump] || prefetchkind[lump] != kind)
+      return NULL;
+
+   data = prefetchdata[lump];
+   prefetchdata[lump] = NULL;
+
+   return data;
+#else
+   return NULL;
+#endif
+}
+
+// EOF
+
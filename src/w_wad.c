@@ -9,7 +9,12 @@
 #else
 #include "keywords.h"
 #endif
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
 #include "doomdef.h"
+#include "w_cache.h"
+#include "w_prefetch.h"
 
 //===============
 //   TYPES
@@ -39,7 +44,8 @@ byte *wadfileptr;
 
 lumpinfo_t *lumpinfo; // points directly to rom image
 int         numlumps;
-void       *lumpcache[MAXLUMPS];
+void      **lumpcache;
+byte      **lumpbase;
 
 void D_strupr(char *s)
 {
@@ -62,36 +68,59 @@ unsigned char *decomp_input;
 unsigned char *decomp_output;
 extern int     decomp_start;
 
-void decode(unsigned char *input, unsigned char *output)
+//
+// CALICO: LZSS decoder, shared with R_decode. Each id byte covers the next
+// eight tokens, lowest bit first: a clear bit is a literal byte, and a set
+// bit is a 12-bit back distance and a 4-bit length, with a length of one
+// ending the stream. An id byte of zero means eight literals in a row, which
+// are copied at once; matches that don't overlap their own output are also
+// copied whole rather than a byte at a time. Returns the number of bytes
+// written.
+//
+int W_Decode(const byte *input, byte *output)
 {
-   int getidbyte = 0;
-   int len;
-   int pos;
-   int i;
-   unsigned char *source;
-   int idbyte = 0;
+   byte       *start = output;
+   const byte *source;
+   int idbyte, bit, pos, len, i;
 
    while(1)
    {
-      // get a new idbyte if necessary
-      if (!getidbyte) idbyte = *input++;
-      getidbyte = (getidbyte + 1) & 7;
+      idbyte = *input++;
 
-      if (idbyte&1)
+      if(!idbyte)
       {
-         // decompress
-         pos = *input++ << LENSHIFT;
-         pos = pos | (*input >> LENSHIFT);
-         source = output - pos - 1;
-         len = (*input++ & 0xf)+1;
-         if (len==1) break;
-         for (i=0 ; i<len ; i++)
-            *output++ = *source++;
-      } else {
-         *output++ = *input++;
+         memcpy(output, input, 8);
+         output += 8;
+         input  += 8;
+         continue;
       }
 
-      idbyte = idbyte >> 1;
+      for(bit = 0; bit < 8; bit++, idbyte >>= 1)
+      {
+         if(!(idbyte & 1))
+         {
+            *output++ = *input++;
+            continue;
+         }
+
+         pos = (input[0] << LENSHIFT) | (input[1] >> LENSHIFT);
+         len = (input[1] & 0xf) + 1;
+         input += 2;
+         if(len == 1)
+            return (int)(output - start);
+
+         source = output - pos - 1;
+         if(pos + 1 >= len)
+            memcpy(output, source, len);  // source ends before output starts
+         else if(!pos)
+            memset(output, *source, len); // run of one byte
+         else
+         {
+            for(i = 0; i < len; i++)
+               output[i] = source[i];
+         }
+         output += len;
+      }
    }
 }
 
@@ -111,9 +140,156 @@ LUMP BASED ROUTINES
 ====================
 */
 
+// used for stripping out the hi bit of the first character of the
+// name of the lump
+#define HIBIT (1<<7)
+
+//
+// CALICO: hashed lump directory
+//
+// Every name is packed into a 64-bit key, with the compression bit stripped
+// and anything after the terminator zeroed, so that comparing two names is
+// a single integer compare. Chains are built in directory order with each
+// lump pushed on the front, so a lookup meets the last occurrence of a name
+// first, as the old backward scan did.
+//
+static uint64_t *lumpkeys;
+static int      *lumphashnext;
+static int      *lumphashheads;
+static unsigned  lumphashmask;
+
+static uint64_t W_NameKey(const char *name, boolean lumpname)
+{
+   uint64_t key = 0;
+   int      i;
+   byte     c;
+
+   for(i = 0; i < 8; i++)
+   {
+      if(!(c = (byte)name[i]))
+         break;
+      if(lumpname)
+         c &= ~HIBIT;
+      else if(c >= 'a' && c <= 'z')
+         c -= 'a'-'A';
+      key |= (uint64_t)c << (i*8);
+   }
+
+   return key;
+}
+
+static unsigned W_KeyHash(uint64_t key)
+{
+   return (unsigned)((key * 0x9E3779B97F4A7C15ULL) >> 32) & lumphashmask;
+}
+
+static void W_HashLumps(void)
+{
+   int      i;
+   unsigned size, hash;
+
+   for(size = 1; size < (unsigned)numlumps * 2; size <<= 1)
+      ;
+   lumphashmask = size - 1;
+
+   lumpkeys      = Z_Malloc(numlumps * sizeof(*lumpkeys),     PU_STATIC, NULL);
+   lumphashnext  = Z_Malloc(numlumps * sizeof(*lumphashnext), PU_STATIC, NULL);
+   lumphashheads = Z_Malloc(size * sizeof(*lumphashheads),    PU_STATIC, NULL);
+
+   for(hash = 0; hash < size; hash++)
+      lumphashheads[hash] = -1;
+
+   for(i = 0; i < numlumps; i++)
+   {
+      lumpkeys[i] = W_NameKey(lumpinfo[i].name, true);
+      hash = W_KeyHash(lumpkeys[i]);
+      lumphashnext[i] = lumphashheads[hash];
+      lumphashheads[hash] = i;
+   }
+}
+
+//
+// CALICO: check whether a PWAD header makes sense for a file of the given
+// size with its fields read as big-endian (the Jaguar's own format) or, if
+// not, little-endian (as written by PC tools). Returns false if neither fits.
+//
+static boolean W_PWADHeader(byte *base, size_t size, int *count, int *ofs, boolean *bigendian)
+{
+   wadinfo_t *header = (wadinfo_t *)base;
+   int i;
+
+   for(i = 0; i < 2; i++)
+   {
+      *bigendian = (i == 0);
+      *count = *bigendian ? BIGLONG(header->numlumps) : LITTLELONG(header->numlumps);
+      *ofs   = *bigendian ? BIGLONG(header->infotableofs) : LITTLELONG(header->infotableofs);
+
+      if(*count >= 0 && *ofs >= (int)sizeof(wadinfo_t) &&
+         (size_t)*ofs + (size_t)*count * sizeof(lumpinfo_t) <= size)
+         return true;
+   }
+
+   return false;
+}
+
+//
+// CALICO: layer PWADs over the IWAD. Their directories are appended to a
+// copy of the IWAD's, with fields stored big-endian like the rest, so a
+// later file's lumps are found by name ahead of earlier ones.
+//
+static void W_AddFiles(byte **files, size_t *sizes, int numfiles)
+{
+   lumpinfo_t *newinfo, *src;
+   int     i, j, n, total;
+   int     counts[MAXWADFILES], ofs[MAXWADFILES];
+   boolean bigendian[MAXWADFILES];
+
+   total = numlumps;
+   for(i = 0; i < numfiles; i++)
+   {
+      if(!W_PWADHeader(files[i], sizes[i], &counts[i], &ofs[i], &bigendian[i]))
+         I_Error("W_AddFiles: bad directory in file %d", i + 1);
+      total += counts[i];
+   }
+
+   lumpbase = Z_Malloc(total * sizeof(*lumpbase), PU_STATIC, NULL);
+   for(n = 0; n < numlumps; n++)
+      lumpbase[n] = wadfileptr;
+
+   if(numfiles)
+   {
+      newinfo = Z_Malloc(total * sizeof(*newinfo), PU_STATIC, NULL);
+      D_memcpy(newinfo, lumpinfo, numlumps * sizeof(*newinfo));
+
+      for(i = 0; i < numfiles; i++)
+      {
+         src = (lumpinfo_t *)(files[i] + ofs[i]);
+         for(j = 0; j < counts[i]; j++, n++)
+         {
+            newinfo[n] = src[j];
+            if(!bigendian[i])
+            {
+               newinfo[n].filepos = BIGLONG(LITTLELONG(src[j].filepos));
+               newinfo[n].size    = BIGLONG(LITTLELONG(src[j].size));
+            }
+            lumpbase[n] = files[i];
+         }
+      }
+
+      lumpinfo = newinfo;
+      numlumps = total;
+   }
+
+   lumpcache = Z_Malloc(numlumps * sizeof(*lumpcache), PU_STATIC, NULL);
+   D_memset(lumpcache, 0, numlumps * sizeof(*lumpcache));
+}
+
 void W_Init(void)
 {
-   int infotableofs;
+   int     infotableofs;
+   byte   *files[MAXWADFILES]; // CALICO
+   size_t  sizes[MAXWADFILES];
+   int     numfiles;
 
    wadfileptr = I_WadBase();
 
@@ -124,11 +300,17 @@ void W_Init(void)
 
    infotableofs = BIGLONG(((wadinfo_t*)wadfileptr)->infotableofs);
    lumpinfo = (lumpinfo_t *) (wadfileptr + infotableofs);
-}
 
-// used for stripping out the hi bit of the first character of the
-// name of the lump
-#define HIBIT (1<<7)
+   // CALICO: add any -file PWADs and index the directory
+   numfiles = I_PWadBases(files, sizes, MAXWADFILES);
+   W_AddFiles(files, sizes, numfiles);
+   W_HashLumps();
+
+   // CALICO: the fast-load cache is keyed by IWAD lump numbers, so it can't
+   // be used when PWADs are layered on top
+   if(!numfiles)
+      W_OpenCache();
+}
 
 //
 // CALICO: For portable lump name comparisons; 7-bit ASCII compare
@@ -168,22 +350,16 @@ int W_strncasecmp(const char *s1, const char *s2, int len)
 
 int W_CheckNumForName(const char *name)
 {
-   char name8[9];
-   lumpinfo_t *lump_p;
+   uint64_t key;
+   int      i;
 
-   D_memset(name8, 0, sizeof(name8));
-   D_strncpy(name8, name, 8);
-   name8[8] = '\0'; // in case the name was a full 8 chars
-   D_strupr(name8); // case insensitive
+   // CALICO: look up through the hash index
+   key = W_NameKey(name, false); // case insensitive
 
-   // scan backwards so patch lump files take precedence
-   lump_p = lumpinfo + numlumps;
-
-   // CALICO: eliminated int-packing hack
-   while(lump_p-- != lumpinfo)
+   for(i = lumphashheads[W_KeyHash(key)]; i != -1; i = lumphashnext[i])
    {
-      if(!W_strncasecmp(lump_p->name, name8, 8))
-         return (int)(lump_p - lumpinfo);
+      if(lumpkeys[i] == key)
+         return i;
    }
 
    return -1;
@@ -248,11 +424,91 @@ void W_ReadLump(int lump, void *dest)
    l = lumpinfo+lump;
    if(l->name[0] & 0x80) // compressed
    {
-      decode((unsigned char *) (wadfileptr + BIGLONG(l->filepos)),
-         (unsigned char *) dest);
+      // CALICO: use an already decoded copy from the fast-load cache or the
+      // prefetcher if there is one
+      const void *cached = W_CacheFind(lump, WC_BYTES, NULL);
+
+      if(cached)
+         memcpy(dest, cached, BIGLONG(l->size));
+      else if(!W_PrefetchCopy(lump, WC_BYTES, dest, BIGLONG(l->size)))
+         W_Decode(lumpbase[lump] + BIGLONG(l->filepos), (byte *)dest);
+   }
+   else
+      D_memcpy(dest, lumpbase[lump] + BIGLONG(l->filepos), BIGLONG(l->size));
+}
+
+/*
+====================
+=
+= W_OpenLumpView
+=
+= CALICO: Returns a pointer to the lump's data, valid until the view is
+= closed. Uncompressed lumps are seen directly in the WAD image, and
+= compressed ones in the fast-load cache or the prefetcher's results if
+= they're there; otherwise the lump is decoded into a scratch block of
+= exactly its size. Data that isn't aligned well enough to read the map
+= structures from is copied to scratch too.
+=
+====================
+*/
+
+const void *W_OpenLumpView(int lump, lumpview_t *view)
+{
+   lumpinfo_t *l;
+   const byte *data;
+
+   if(lump < 0 || lump >= numlumps)
+      I_Error("W_OpenLumpView: %i >= numlumps", lump);
+   l = lumpinfo + lump;
+
+   view->size    = BIGLONG(l->size);
+   view->scratch = NULL;
+   view->owned   = NULL;
+
+   if(l->name[0] & 0x80) // compressed
+   {
+      if(!(data = W_CacheFind(lump, WC_BYTES, NULL)))
+         data = view->owned = W_PrefetchTake(lump, WC_BYTES);
    }
    else
-      D_memcpy(dest, wadfileptr + BIGLONG(l->filepos), BIGLONG(l->size));
+      data = lumpbase[lump] + BIGLONG(l->filepos);
+
+   if(data && !((uintptr_t)data & 3))
+      return (view->data = data);
+
+   view->scratch = Z_Malloc(view->size ? view->size : 1, PU_STATIC, 0);
+   if(data)
+      memcpy(view->scratch, data, view->size);
+   else
+      W_Decode(lumpbase[lump] + BIGLONG(l->filepos), view->scratch);
+
+   if(view->owned)
+   {
+      free(view->owned);
+      view->owned = NULL;
+   }
+
+   return (view->data = view->scratch);
+}
+
+/*
+====================
+=
+= W_CloseLumpView
+=
+====================
+*/
+
+void W_CloseLumpView(lumpview_t *view)
+{
+   if(view->scratch)
+      Z_Free(view->scratch);
+   if(view->owned)
+      free(view->owned);
+
+   view->data    = NULL;
+   view->scratch = NULL;
+   view->owned   = NULL;
 }
 
 /*
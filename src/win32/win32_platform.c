@@ -166,6 +166,37 @@ static hal_bool Win32_FileExists(const char *path)
     return res;
 }
 
+//
+// Map an entire open file into memory read-only. The view stays valid after
+// the file and the mapping object are closed. Returns NULL on failure.
+//
+static void *Win32_MapFile(FILE *f, size_t *size)
+{
+    HANDLE hFile = (HANDLE)_get_osfhandle(_fileno(f));
+    HANDLE hMap;
+    LARGE_INTEGER fileSize;
+    void *data;
+
+    if(hFile == INVALID_HANDLE_VALUE || !GetFileSizeEx(hFile, &fileSize) || fileSize.QuadPart <= 0)
+        return NULL;
+
+    if(!(hMap = CreateFileMappingW(hFile, NULL, PAGE_READONLY, 0, 0, NULL)))
+        return NULL;
+
+    data = MapViewOfFile(hMap, FILE_MAP_READ, 0, 0, 0);
+    CloseHandle(hMap);
+    if(!data)
+        return NULL;
+
+    *size = (size_t)fileSize.QuadPart;
+    return data;
+}
+
+static void Win32_UnmapFile(void *data, size_t size)
+{
+    UnmapViewOfFile(data);
+}
+
 //
 // Populate the HAL platform interface with Win32 implementation function pointers
 //
@@ -177,6 +208,8 @@ void Win32_InitHAL(void)
    hal_platform.setIcon     = Win32_SetIcon;
    hal_platform.fileOpen    = Win32_FileOpen;
    hal_platform.fileExists  = Win32_FileExists;
+   hal_platform.mapFile     = Win32_MapFile;
+   hal_platform.unmapFile   = Win32_UnmapFile;
 }
 
 #endif
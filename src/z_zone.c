@@ -1,6 +1,10 @@
 /* Z_zone.c */
 
 #include <stdint.h>
+#include <stdlib.h>
+#ifndef YAUL_DOOM
+#include "elib/m_argv.h"
+#endif
 #include "doomdef.h"
 
 /* 
@@ -16,11 +20,297 @@ The rover can be left pointing at a non-empty block
 It is of no value to free a cachable block, because it will get overwritten
 automatically if needed
 
+CALICO: a zone can instead be managed with a two-level segregated fit (TLSF)
+allocator. Free blocks are then merged with their neighbours as soon as they
+are freed, and kept on lists by size class, so that finding one that fits is
+a couple of bitmap lookups however many blocks the zone holds. Purgable
+blocks are only thrown out when no free block fits, by a sweep from the
+rover like the original allocator's. The block list, tags, user pointers and
+lockframes work the same either way. -zonerover selects the original
+allocator.
+
 ============================================================================== 
 */ 
  
 memzone_t *mainzone;
 memzone_t *refzone;
+
+#define MINFRAGMENT 64
+
+// TLSF size classes: below ZSMALLBLOCK bytes, first level 0 is split
+// linearly; above it, each power of two is a first level split into
+// ZSLCOUNT second levels.
+#define ZSLLOG2     3
+#define ZFLSHIFT    7
+#define ZSMALLBLOCK (1 << ZFLSHIFT)
+
+// a free block's list links are kept in the space after its header
+typedef struct zfreelink_s
+{
+   memblock_t *next;
+   memblock_t *prev;
+} zfreelink_t;
+
+#define Z_FREELINK(b) ((zfreelink_t *)((byte *)(b) + sizeof(memblock_t)))
+#define Z_MINBLOCK    ((int)(sizeof(memblock_t) + sizeof(zfreelink_t) + 7) & ~7)
+
+//
+// Index of the highest set bit
+//
+static int Z_fls(unsigned int x)
+{
+#if defined(__GNUC__)
+   return 31 - __builtin_clz(x);
+#else
+   int bit = 0;
+   while(x >>= 1)
+      ++bit;
+   return bit;
+#endif
+}
+
+//
+// Index of the lowest set bit
+//
+static int Z_ffs(unsigned int x)
+{
+#if defined(__GNUC__)
+   return __builtin_ctz(x);
+#else
+   int bit = 0;
+   while(!(x & 1))
+   {
+      x >>= 1;
+      ++bit;
+   }
+   return bit;
+#endif
+}
+
+//
+// Get the size class of a block of the given size
+//
+static void Z_mapping(int size, int *fl, int *sl)
+{
+   int t;
+
+   if(size < ZSMALLBLOCK)
+   {
+      *fl = 0;
+      *sl = size / (ZSMALLBLOCK / ZSLCOUNT);
+   }
+   else
+   {
+      t   = Z_fls((unsigned int)size);
+      *sl = (size >> (t - ZSLLOG2)) ^ ZSLCOUNT;
+      *fl = t - (ZFLSHIFT - 1);
+   }
+}
+
+//
+// Put a free block on the list for its size class
+//
+static void Z_insertFree(memzone_t *zone, memblock_t *block)
+{
+   int fl, sl;
+   memblock_t *head;
+
+   Z_mapping(block->size, &fl, &sl);
+
+   head = zone->freelists[fl][sl];
+   Z_FREELINK(block)->prev = NULL;
+   Z_FREELINK(block)->next = head;
+   if(head)
+      Z_FREELINK(head)->prev = block;
+   zone->freelists[fl][sl] = block;
+
+   zone->flbitmap     |= 1u << fl;
+   zone->slbitmap[fl] |= 1u << sl;
+}
+
+//
+// Take a free block off its list
+//
+static void Z_removeFree(memzone_t *zone, memblock_t *block)
+{
+   int fl, sl;
+   zfreelink_t *link = Z_FREELINK(block);
+
+   Z_mapping(block->size, &fl, &sl);
+
+   if(link->next)
+      Z_FREELINK(link->next)->prev = link->prev;
+   if(link->prev)
+      Z_FREELINK(link->prev)->next = link->next;
+   else
+   {
+      zone->freelists[fl][sl] = link->next;
+      if(!link->next)
+      {
+         zone->slbitmap[fl] &= ~(1u << sl);
+         if(!zone->slbitmap[fl])
+            zone->flbitmap &= ~(1u << fl);
+      }
+   }
+}
+
+//
+// Find a free block of at least size bytes, without taking it off its list
+//
+static memblock_t *Z_findFree(memzone_t *zone, int size)
+{
+   int fl, sl;
+   unsigned int map;
+
+   // round up to the next size class, so any block in it is big enough
+   if(size >= ZSMALLBLOCK)
+      size += (1 << (Z_fls((unsigned int)size) - ZSLLOG2)) - 1;
+   Z_mapping(size, &fl, &sl);
+   if(fl >= ZFLCOUNT)
+      return NULL;
+
+   map = zone->slbitmap[fl] & (~0u << sl);
+   if(!map)
+   {
+      if(fl + 1 >= ZFLCOUNT || !(map = zone->flbitmap & (~0u << (fl + 1))))
+         return NULL;
+      fl  = Z_ffs(map);
+      map = zone->slbitmap[fl];
+   }
+   sl = Z_ffs(map);
+
+   return zone->freelists[fl][sl];
+}
+
+//
+// Mark a block free, merge it with any free neighbours, and put the result
+// on the free lists. Returns the merged block.
+//
+static memblock_t *Z_releaseBlock(memzone_t *zone, memblock_t *block)
+{
+   memblock_t *other;
+
+   block->user = NULL;
+   block->tag  = 0;
+   block->id   = 0;
+
+   if((other = block->next) && !other->user)
+   {
+      Z_removeFree(zone, other);
+      block->size += other->size;
+      block->next  = other->next;
+      if(other->next)
+         other->next->prev = block;
+      if(zone->rover == other)
+         zone->rover = block;
+   }
+
+   if((other = block->prev) && !other->user)
+   {
+      Z_removeFree(zone, other);
+      other->size += block->size;
+      other->next  = block->next;
+      if(block->next)
+         block->next->prev = other;
+      if(zone->rover == block)
+         zone->rover = other;
+      block = other;
+   }
+
+   Z_insertFree(zone, block);
+
+   return block;
+}
+
+//
+// Purgable blocks can be thrown out to make room
+//
+static boolean Z_isPurgable(memblock_t *block)
+{
+   return block->user && block->tag >= PU_PURGELEVEL && block->lockframe != framecount;
+}
+
+//
+// Purge a block, clearing its owner's pointer
+//
+static memblock_t *Z_purgeBlock(memzone_t *zone, memblock_t *block)
+{
+   // CALICO_FIXME: non-portable pointer comparison
+   if(block->user > (void **)0x100)
+      *block->user = NULL;
+
+   return Z_releaseBlock(zone, block);
+}
+
+//
+// No free block fits, so sweep around the zone from the rover throwing out
+// purgable blocks until one does. Returns the free block, or NULL.
+//
+static memblock_t *Z_purgeFor(memzone_t *zone, int size)
+{
+   memblock_t *block;
+   byte       *start = (byte *)zone->rover;
+   int         pass;
+
+   for(pass = 0; pass < 2; pass++)
+   {
+      block = pass ? &zone->blocklist : zone->rover;
+
+      for(; block && (!pass || (byte *)block < start); block = block->next)
+      {
+         if(!Z_isPurgable(block))
+            continue;
+
+         block = Z_purgeBlock(zone, block);
+         if(block->size >= size)
+         {
+            zone->rover = block->next ? block->next : &zone->blocklist;
+            return block;
+         }
+      }
+   }
+
+   return NULL;
+}
+
+//
+// TLSF allocation
+//
+static memblock_t *Z_tlsfMalloc(memzone_t *zone, int size)
+{
+   int         extra;
+   memblock_t *base, *newblock;
+
+   if(size < Z_MINBLOCK)
+      size = Z_MINBLOCK;
+
+   if(!(base = Z_findFree(zone, size)) && !(base = Z_purgeFor(zone, size)))
+      return NULL;
+
+   Z_removeFree(zone, base);
+
+   extra = base->size - size;
+   if(extra > MINFRAGMENT)
+   {
+      // return the remainder to the free lists; it can't have a free block
+      // after it, since base didn't
+      newblock = (memblock_t *)((byte *)base + size);
+      newblock->size = extra;
+      newblock->user = NULL;
+      newblock->tag  = 0;
+      newblock->id   = 0;
+      newblock->lockframe = -1;
+      newblock->prev = base;
+      newblock->next = base->next;
+      if(newblock->next)
+         newblock->next->prev = newblock;
+      base->next = newblock;
+      base->size = size;
+      Z_insertFree(zone, newblock);
+   }
+
+   return base;
+}
  
 /*
 ========================
@@ -30,13 +320,15 @@ memzone_t *refzone;
 ========================
 */
 
-memzone_t *Z_InitZone(byte *base, int size)
+memzone_t *Z_InitZone(byte *base, int size, int allocator)
 {
    memzone_t *zone;
 
    zone = (memzone_t *)base;
+   D_memset(zone, 0, sizeof(*zone));
 
    zone->size = size;
+   zone->allocator = allocator;
    zone->rover = &zone->blocklist;
    zone->blocklist.size = size - (int)((byte *)&zone->blocklist - (byte *)zone);
    zone->blocklist.user = NULL;
@@ -46,6 +338,9 @@ memzone_t *Z_InitZone(byte *base, int size)
    zone->blocklist.prev = NULL;
    zone->blocklist.lockframe = -1;
 
+   if(allocator == ZA_TLSF)
+      Z_insertFree(zone, &zone->blocklist);
+
    return zone;
 }
 
@@ -62,6 +357,7 @@ void Z_Init(void)
    byte *mem;
    int   size;
    int   chunk = 0x80000;
+   int   allocator = ZA_TLSF;
 
    mem = I_ZoneBase(&size);
 
@@ -70,8 +366,13 @@ void Z_Init(void)
    chunk *= 2;
 #endif
 
-   mainzone = Z_InitZone(mem, chunk);
-   refzone  = Z_InitZone(mem + chunk, size - chunk);
+#ifndef YAUL_DOOM
+   if(M_FindArgument("-zonerover"))
+      allocator = ZA_ROVER;
+#endif
+
+   mainzone = Z_InitZone(mem, chunk, allocator);
+   refzone  = Z_InitZone(mem + chunk, size - chunk, allocator);
 }
 
 /*
@@ -93,6 +394,14 @@ void Z_Free2(memzone_t *mainzone, void *ptr)
    // CALICO_TODO: non-portable pointer comparison
    if(block->user > (void **)0x100) // smaller values are not pointers
       *block->user = 0;             // clear the user's mark
+
+   // CALICO: TLSF zones merge and list free blocks right away
+   if(mainzone->allocator == ZA_TLSF)
+   {
+      Z_releaseBlock(mainzone, block);
+      return;
+   }
+
    block->user = NULL; // mark as free
    block->tag = 0;
    block->id = 0;
@@ -101,15 +410,13 @@ void Z_Free2(memzone_t *mainzone, void *ptr)
 /*
 ========================
 =
-= Z_Malloc2
+= Z_roverMalloc
 =
-= You can pass a NULL user if the tag is < PU_PURGELEVEL
+= CALICO: The original Z_Malloc2 search; returns NULL when nothing fits
 ========================
 */
 
-#define MINFRAGMENT 64
-
-void *Z_Malloc2(memzone_t *mainzone, int size, int tag, void *user)
+static memblock_t *Z_roverMalloc(memzone_t *mainzone, int size)
 {
    int         extra;
    memblock_t *start, *rover, *newblock, *base;
@@ -118,9 +425,6 @@ void *Z_Malloc2(memzone_t *mainzone, int size, int tag, void *user)
    // scan through the block list looking for the first free block
    // of sufficient size, throwing out any purgable blocks along the way
    //
-   size += sizeof(memblock_t); // account for size of block header
-   size = (size + 7) & ~7;     // phrase align everything
-
    start = base = mainzone->rover;
 
    while(base->user || base->size < size)
@@ -144,7 +448,7 @@ backtostart:
          }
 
          if(base == start) // scaned all the way around the list
-            I_Error("Z_Malloc: failed on %i", size);
+            return NULL;
          continue;
       }
 
@@ -183,6 +487,40 @@ backtostart:
       base->size = size;
    }
 
+   mainzone->rover = base->next; // next allocation will start looking here
+   if(!mainzone->rover)
+      mainzone->rover = &mainzone->blocklist;
+
+   return base;
+}
+
+/*
+========================
+=
+= Z_TryMalloc
+=
+= CALICO: Z_Malloc2 that returns NULL when there is no room
+========================
+*/
+
+void *Z_TryMalloc(memzone_t *mainzone, int size, int tag, void *user)
+{
+   memblock_t *base;
+
+   if(!user && tag >= PU_PURGELEVEL)
+      I_Error("Z_Malloc: an owner is required for purgable blocks");
+
+   size += sizeof(memblock_t); // account for size of block header
+   size = (size + 7) & ~7;     // phrase align everything
+
+   if(mainzone->allocator == ZA_TLSF)
+      base = Z_tlsfMalloc(mainzone, size);
+   else
+      base = Z_roverMalloc(mainzone, size);
+
+   if(!base)
+      return NULL;
+
    if(user)
    {
       base->user = user; // mark as an in use block
@@ -190,8 +528,6 @@ backtostart:
    }
    else
    {
-      if(tag >= PU_PURGELEVEL)
-         I_Error("Z_Malloc: an owner is required for purgable blocks");
       // CALICO_FIXME: non-portable idiom...
       base->user = (void **)2; // mark as in use, but unowned
    }
@@ -199,13 +535,28 @@ backtostart:
    base->id = ZONEID;
    base->lockframe = -1;
 
-   mainzone->rover = base->next; // next allocation will start looking here
-   if(!mainzone->rover)
-      mainzone->rover = &mainzone->blocklist;
-
    return (void *)((byte *)base + sizeof(memblock_t));
 }
 
+/*
+========================
+=
+= Z_Malloc2
+=
+= You can pass a NULL user if the tag is < PU_PURGELEVEL
+========================
+*/
+
+void *Z_Malloc2(memzone_t *mainzone, int size, int tag, void *user)
+{
+   void *ptr;
+
+   if(!(ptr = Z_TryMalloc(mainzone, size, tag, user)))
+      I_Error("Z_Malloc: failed on %i", size);
+
+   return ptr;
+}
+
 /*
 ========================
 =
@@ -224,7 +575,17 @@ void Z_FreeTags(memzone_t *mainzone)
       if(!block->user)
          continue;        // free block
       if(block->tag == PU_LEVEL || block->tag == PU_LEVSPEC)
-         Z_Free2(mainzone, (byte *)block + sizeof(memblock_t));
+      {
+         // CALICO: in a TLSF zone the block is merged with its free
+         // neighbours, so carry on from whatever follows the merged block
+         if(mainzone->allocator == ZA_TLSF)
+         {
+            block = Z_purgeBlock(mainzone, block);
+            next  = block->next;
+         }
+         else
+            Z_Free2(mainzone, (byte *)block + sizeof(memblock_t));
+      }
    }
 }
 
@@ -253,6 +614,8 @@ void Z_CheckHeap(memzone_t *mainzone)
          I_Error("Z_CheckHeap: block size does not touch the next block\n");
       if(checkblock->next->prev != checkblock)
          I_Error("Z_CheckHeap: next block doesn't have proper back link\n");
+      if(mainzone->allocator == ZA_TLSF && !checkblock->user && !checkblock->next->user)
+         I_Error("Z_CheckHeap: two consecutive free blocks\n"); // CALICO
    }
 }
 
@@ -298,5 +661,127 @@ int Z_FreeMemory(memzone_t *mainzone)
    return free;
 }
 
+/*
+========================
+=
+= Z_LargestFree
+=
+= CALICO: size of the largest run of free memory, counting neighbouring free
+= blocks the rover has not merged yet as one
+=
+========================
+*/
+
+int Z_LargestFree(memzone_t *mainzone)
+{
+   memblock_t *block;
+   int         run, largest;
+
+   run = largest = 0;
+   for(block = &mainzone->blocklist; block; block = block->next)
+   {
+      if(block->user)
+         run = 0;
+      else if((run += block->size) > largest)
+         largest = run;
+   }
+   return largest;
+}
+
+/*
+========================
+=
+= Z_BenchZone
+=
+= CALICO: stress test for -benchzone. Runs a level's worth of mixed
+= allocations, frees and purgable cache blocks, with a level change every so
+= often, in a scratch zone the size of mainzone using the given allocator.
+= The same seed gives the same sequence of requests for either allocator.
+=
+========================
+*/
+
+#define ZB_SLOTS   1024
+#define ZB_STEPS   200000
+#define ZB_LEVEL   20000 // steps between level changes
+
+void Z_BenchZone(int allocator, int seed, zonebench_t *bench)
+{
+#ifndef YAUL_DOOM
+   static void *slots[ZB_SLOTS];
+   memzone_t   *zone;
+   byte        *mem;
+   int          i, step, size, tag, r, zonesize;
+   unsigned int rng = (unsigned int)seed, start, elapsed;
+   double       total = 0.0;
+
+   D_memset(bench, 0, sizeof(*bench));
+   D_memset(slots, 0, sizeof(slots));
+
+   zonesize = 0x80000;
+#if defined(CALICO_IS_X64)
+   zonesize *= 2;
+#endif
+   mem  = malloc(zonesize);
+   zone = Z_InitZone(mem, zonesize, allocator);
+
+   for(step = 0; step < ZB_STEPS; step++)
+   {
+      rng = rng * 1103515245u + 12345u;
+      r   = (int)((rng >> 8) & 0xffff);
+      i   = r % ZB_SLOTS;
+
+      if(step % ZB_LEVEL == ZB_LEVEL - 1)
+      {
+         Z_FreeTags(zone);
+         continue;
+      }
+
+      if(slots[i])
+      {
+         // purgable blocks are left until they're purged
+         memblock_t *block = (memblock_t *)((byte *)slots[i] - sizeof(memblock_t));
+         if(block->tag < PU_PURGELEVEL)
+            Z_Free2(zone, slots[i]);
+         continue;
+      }
+
+      rng = rng * 1103515245u + 12345u;
+      r   = (int)((rng >> 8) & 0xffff);
+
+      // mostly small level data, some lumps, the odd large texture
+      if(r % 100 < 70)
+         size = 16 + r % 240;
+      else if(r % 100 < 95)
+         size = 256 + (r * 7) % 3840;
+      else
+         size = 4096 + (r * 13) % 28672;
+
+      if(r % 5 == 0)
+         tag = PU_CACHE;
+      else if(r % 5 < 3)
+         tag = PU_LEVEL;
+      else
+         tag = PU_STATIC;
+
+      ++bench->allocs;
+      start = I_GetTimeUS();
+      if(!Z_TryMalloc(zone, size, tag, &slots[i]))
+         ++bench->failures;
+      elapsed = I_GetTimeUS() - start;
+
+      total += elapsed;
+      if(elapsed > bench->maxus)
+         bench->maxus = elapsed;
+   }
+
+   bench->avgus       = bench->allocs ? total / bench->allocs : 0.0;
+   bench->freebytes   = Z_FreeMemory(zone);
+   bench->largestfree = Z_LargestFree(zone);
+
+   free(mem);
+#endif
+}
+
 // EOF
 